@@ -0,0 +1,564 @@
+// Timings of the batched and vectorised paths against the code they replaced,
+// and checks that they give the same answers. Build the Release configuration
+// and run from a console. With no arguments every section runs; otherwise only
+// the ones named on the command line. The exit code is 1 if a check failed.
+#include <Eigen/Dense>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#include "PolyFit.h"
+#include "FitBatch.h"
+#include "EvalPoly.h"
+#include "GridEvaluator.h"
+#include "InterpolationPack.h"
+#include "MaxAreaTriangle.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Written to by every timed body so the optimiser cannot drop the work.
+double sink = 0;
+
+// Fastest of several runs, in milliseconds.
+template<typename Body>
+double bestMilliseconds(int runs, Body body)
+{
+	double best = 0;
+	for (int run = 0; run < runs; ++run) {
+		const auto start = std::chrono::steady_clock::now();
+		body();
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		if (run == 0 || elapsed.count() < best) {
+			best = elapsed.count();
+		}
+	}
+	return best;
+}
+
+// count point sets of size points each, noisy samples of a cubic.
+std::vector<PointSet> randomSets(size_t count, size_t size, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> x(-10.0, 10.0);
+	std::normal_distribution<double> noise(0.0, 0.1);
+
+	std::vector<PointSet> sets(count, PointSet(size));
+	for (PointSet& set : sets) {
+		for (auto& point : set) {
+			point.first = x(generator);
+			point.second = 0.5 * point.first * point.first * point.first - point.first + 2 + noise(generator);
+		}
+	}
+	return sets;
+}
+
+// fitBatch throughput against the single-threaded loop it replaces.
+template<int Degree>
+void benchFitBatch(const std::vector<PointSet>& sets)
+{
+	const double count = static_cast<double>(sets.size());
+	std::printf("  degree %d, %zu sets of %zu points\n", Degree, sets.size(), sets.front().size());
+
+	const double serial = bestMilliseconds(3, [&] {
+		for (const PointSet& set : sets) {
+			sink += PolyFit<Degree>::fit(set)(0);
+		}
+	});
+	std::printf("    serial loop   %9.1f ms  %8.2f Mfits/s\n", serial, count / serial / 1e3);
+
+	const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned threads = 1;; threads = std::min(threads * 2, hardware)) {
+		ThreadPool pool(threads);
+		const double batched = bestMilliseconds(3, [&] {
+			sink += fitBatch<Degree>(sets, pool).back()(0);
+		});
+		std::printf("    %3u threads   %9.1f ms  %8.2f Mfits/s\n", threads, batched, count / batched / 1e3);
+		if (threads == hardware) {
+			break;
+		}
+	}
+}
+
+void benchFitBatch()
+{
+	std::printf("fitbatch: fits per second against thread count\n");
+	const std::vector<PointSet> sets = randomSets(1000000, 16, 1);
+	benchFitBatch<2>(sets);
+	benchFitBatch<3>(sets);
+}
+
+// The fit findParabola and findCubicPolynom did before PolyFit: a heap
+// allocated design matrix filled with std::pow and a dynamic
+// column-pivoting QR.
+template<int Degree>
+Eigen::VectorXd dynamicQrFit(const PointSet& points)
+{
+	const Eigen::Index n = static_cast<Eigen::Index>(points.size());
+	Eigen::MatrixXd A(n, Degree + 1);
+	Eigen::VectorXd b(n);
+	for (Eigen::Index i = 0; i < n; ++i) {
+		for (int k = 0; k <= Degree; ++k) {
+			A(i, k) = std::pow(points[i].first, Degree - k);
+		}
+		b(i) = points[i].second;
+	}
+	return A.colPivHouseholderQr().solve(b);
+}
+
+// Exactly determined Degree+1 point fits: one QR per call, one PolyFit per
+// call, and packs of PackLanes solved together.
+template<int Degree>
+void benchPacks(const std::vector<PointSet>& sets)
+{
+	const size_t packCount = sets.size() / PackLanes;
+	std::vector<InterpolationPack<Degree>> packs(packCount);
+	std::vector<CoeffPack<Degree>> out(packCount);
+	for (size_t p = 0; p < packCount; ++p) {
+		for (int lane = 0; lane < PackLanes; ++lane) {
+			setLane(packs[p], lane, sets[p * PackLanes + lane]);
+		}
+	}
+	const double count = static_cast<double>(packCount * PackLanes);
+
+	const double dynamic = bestMilliseconds(3, [&] {
+		for (size_t i = 0; i < packCount * PackLanes; ++i) {
+			sink += dynamicQrFit<Degree>(sets[i])(0);
+		}
+	});
+	const double single = bestMilliseconds(3, [&] {
+		for (size_t i = 0; i < packCount * PackLanes; ++i) {
+			sink += PolyFit<Degree>::fit(sets[i])(0);
+		}
+	});
+	const double packed = bestMilliseconds(3, [&] {
+		solveInterpolationPacks<Degree>(packs, out);
+		sink += out.back().c[0][0];
+	});
+	std::printf("  degree %d: colPivHouseholderQr %8.1f ns/fit, PolyFit %6.2f ns/fit, packs %6.2f ns/fit\n",
+		Degree, dynamic * 1e6 / count, single * 1e6 / count, packed * 1e6 / count);
+}
+
+void benchPacks()
+{
+	std::printf("packs: lane-parallel interpolation against one QR per system\n");
+	benchPacks<2>(randomSets(1 << 20, 3, 2));
+	benchPacks<3>(randomSets(1 << 20, 4, 3));
+}
+
+// The mixed-precision fit tried for the fit path and left out of it: the
+// normal equations of the rows scaled to u = x / s (s the largest |x|)
+// factored by a float Cholesky, then refined in double with the corrected
+// seminormal equations, L L^T d = A^T (b - A c). Falls back to PolyFit when
+// the float factor fails or does not reach double accuracy.
+template<int Degree>
+Eigen::Matrix<double, Degree + 1, 1> mixedPrecisionFit(const PointSet& points)
+{
+	constexpr int Terms = Degree + 1;
+	constexpr int MaxRefinements = 10;
+	using Coeffs = Eigen::Matrix<double, Terms, 1>;
+	using Row = Eigen::Matrix<double, 1, Terms>;
+	using FloatGram = Eigen::Matrix<float, Terms, Terms>;
+	using FloatVector = Eigen::Matrix<float, Terms, 1>;
+
+	double s = 0;
+	for (const auto& point : points) {
+		s = std::max(s, std::abs(point.first));
+	}
+	if (points.size() < Terms || !(s > 0) || !std::isfinite(s)) {
+		return PolyFit<Degree>::fit(points);
+	}
+
+	FloatGram G = FloatGram::Zero();
+	FloatVector h = FloatVector::Zero();
+	for (const auto& point : points) {
+		Row a;
+		PolyFit<Degree>::fillRow(a, 0, point.first / s);
+		const FloatVector row = a.transpose().template cast<float>();
+		G.template selfadjointView<Eigen::Lower>().rankUpdate(row);
+		h += row * static_cast<float>(point.second);
+	}
+	const Eigen::LLT<FloatGram> llt(G);
+	if (llt.info() != Eigen::Success) {
+		return PolyFit<Degree>::fit(points);
+	}
+	const Eigen::Matrix<double, Terms, Terms> L = llt.matrixL().toDenseMatrix().template cast<double>();
+	const auto lower = L.template triangularView<Eigen::Lower>();
+	const auto solveGram = [&](const Coeffs& v) -> Coeffs { return lower.transpose().solve(lower.solve(v)); };
+
+	const double epsilon = std::numeric_limits<double>::epsilon();
+	Coeffs c = solveGram(h.template cast<double>());
+	for (int iteration = 0; iteration < MaxRefinements; ++iteration) {
+		Coeffs g = Coeffs::Zero();
+		for (const auto& point : points) {
+			Row a;
+			PolyFit<Degree>::fillRow(a, 0, point.first / s);
+			g += a.transpose() * (point.second - a.dot(c));
+		}
+		const Coeffs d = solveGram(g);
+		c += d;
+		if (d.cwiseAbs().maxCoeff() <= 4 * epsilon * c.cwiseAbs().maxCoeff()) {
+			double scale = 1;
+			for (int k = Degree - 1; k >= 0; --k) {
+				scale *= s;
+				c(k) /= scale;
+			}
+			return c;
+		}
+	}
+	return PolyFit<Degree>::fit(points);
+}
+
+// Float partial-pivot LU with the classic refinement X += (LU)^-1 (I - A X),
+// the residual formed in double; A.inverse() when it does not converge.
+Eigen::MatrixXd mixedPrecisionInverse(const Eigen::MatrixXd& A)
+{
+	constexpr int MaxRefinements = 10;
+	const Eigen::PartialPivLU<Eigen::MatrixXf> lu(A.cast<float>());
+	const Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(A.rows(), A.cols());
+	Eigen::MatrixXd X = lu.solve(identity.cast<float>()).cast<double>();
+	for (int iteration = 0; iteration < MaxRefinements && X.allFinite(); ++iteration) {
+		const Eigen::MatrixXd D = lu.solve((identity - A * X).cast<float>()).cast<double>();
+		X += D;
+		if (D.cwiseAbs().maxCoeff() <= 4 * std::numeric_limits<double>::epsilon() * X.cwiseAbs().maxCoeff()) {
+			return X;
+		}
+	}
+	return A.inverse();
+}
+
+// Mixed precision against the all-double fit and inverse, on the sizes it was
+// measured on when it was considered for the fit path.
+template<int Degree>
+void benchMixedFit(size_t count, size_t size)
+{
+	const std::vector<PointSet> sets = randomSets(count, size, static_cast<unsigned>(7 + Degree));
+	std::vector<Eigen::Matrix<double, Degree + 1, 1>> doubles(count), mixed(count);
+
+	const double dynamic = bestMilliseconds(3, [&] {
+		for (const PointSet& set : sets) {
+			sink += dynamicQrFit<Degree>(set)(0);
+		}
+	});
+	const double single = bestMilliseconds(3, [&] {
+		for (size_t i = 0; i < count; ++i) {
+			doubles[i] = PolyFit<Degree>::fit(sets[i]);
+		}
+	});
+	const double refined = bestMilliseconds(3, [&] {
+		for (size_t i = 0; i < count; ++i) {
+			mixed[i] = mixedPrecisionFit<Degree>(sets[i]);
+		}
+	});
+
+	double difference = 0;
+	for (size_t i = 0; i < count; ++i) {
+		difference = std::max(difference, (mixed[i] - doubles[i]).cwiseAbs().maxCoeff() / doubles[i].cwiseAbs().maxCoeff());
+	}
+	std::printf("  degree %d, %6zu fits of %5zu points: colPivHouseholderQr %7.1f ms, PolyFit %7.1f ms, mixed %7.1f ms, max difference %.1e\n",
+		Degree, count, size, dynamic, single, refined, difference);
+}
+
+void benchMixed()
+{
+	std::printf("mixed: float factor with double refinement against double\n");
+	benchMixedFit<2>(100000, 20);
+	benchMixedFit<3>(100000, 50);
+	benchMixedFit<3>(2000, 5000);
+	benchMixedFit<7>(5000, 500);
+
+	std::mt19937 generator(8);
+	std::uniform_real_distribution<double> entry(-1.0, 1.0);
+	for (const Eigen::Index n : {64, 256, 1024}) {
+		Eigen::MatrixXd A(n, n);
+		for (Eigen::Index i = 0; i < A.size(); ++i) {
+			A.data()[i] = entry(generator);
+		}
+		A.diagonal().array() += static_cast<double>(n);
+
+		Eigen::MatrixXd X, Y;
+		const double doubleInverse = bestMilliseconds(3, [&] { X = A.inverse(); sink += X(0, 0); });
+		const double mixedInverse = bestMilliseconds(3, [&] { Y = mixedPrecisionInverse(A); sink += Y(0, 0); });
+		std::printf("  inverse %4td x %4td: double %8.1f ms, mixed %8.1f ms, max difference %.1e\n",
+			n, n, doubleInverse, mixedInverse, (Y - X).cwiseAbs().maxCoeff() / X.cwiseAbs().maxCoeff());
+	}
+}
+
+// The O(n^3) loop Main.cpp ran before maxAreaTriangle, over every ordered
+// triple. It is the reference the faster searches are checked against.
+PointSet bestTriangleReference(const PointSet& points)
+{
+	double maxArea = 0;
+	PointSet best(3);
+	for (size_t i = 0; i < points.size(); ++i) {
+		for (size_t j = 0; j < points.size(); ++j) {
+			for (size_t k = 0; k < points.size(); ++k) {
+				const double area = 0.5 * std::abs(cross(points[i], points[j], points[k]));
+				if (area > maxArea) {
+					maxArea = area;
+					best = {points[i], points[j], points[k]};
+				}
+			}
+		}
+	}
+	return best;
+}
+
+// Uniform points in a square, from 10 to 10^7 of them. The i < j < k scan
+// and the reference only run while they finish in seconds.
+void benchTriangle()
+{
+	std::printf("triangle: maxAreaTriangle against the O(n^3) reference loop\n");
+	std::mt19937 generator(4);
+	std::uniform_real_distribution<double> coordinate(-100.0, 100.0);
+	for (size_t n = 10; n <= 10000000; n *= 10) {
+		PointSet points(n);
+		for (auto& point : points) {
+			point = {coordinate(generator), coordinate(generator)};
+		}
+		const int runs = n <= 100000 ? 5 : 1;
+
+		const double hull = bestMilliseconds(runs, [&] { sink += maxAreaTriangleHull(points)[0].first; });
+		std::printf("  n = %8zu: hull %10.3f ms", n, hull);
+		if (n <= 1000) {
+			const double scan = bestMilliseconds(runs, [&] { sink += maxAreaTriangleBruteForce(points)[0].first; });
+			const double reference = bestMilliseconds(1, [&] { sink += bestTriangleReference(points)[0].first; });
+			std::printf(", scan %10.3f ms, reference %10.3f ms", scan, reference);
+		}
+		std::printf("\n");
+	}
+}
+
+double triangleArea(const PointSet& triangle)
+{
+	return 0.5 * std::abs(cross(triangle[0], triangle[1], triangle[2]));
+}
+
+// The hull search and the i < j < k scan must find a triangle of the same area
+// as the reference, made of input points, on random sets and on the inputs
+// where the hull degenerates: fewer than three points, repeated points and
+// collinear points.
+bool checkTriangle()
+{
+	std::vector<PointSet> sets = {
+		{},
+		{{1, 2}},
+		{{1, 2}, {3, -1}},
+		{{1, 1}, {1, 1}, {1, 1}, {1, 1}},
+		{{0, 0}, {1, 1}, {2, 2}, {3, 3}, {-4, -4}},
+		{{0, 0}, {2, 1}, {2, 1}, {4, 2}, {0, 0}, {-2, -1}},
+		{{5, 0}, {5, 3}, {5, -7}, {5, 3}},
+		{{0, 0}, {4, 0}, {4, 3}, {0, 0}, {4, 0}, {4, 3}},
+		{{0, 0}, {1, 0}, {2, 0}, {3, 0}, {1.5, 1e-9}},
+	};
+	PointSet grid;
+	for (int x = -3; x <= 3; ++x) {
+		for (int y = -2; y <= 2; ++y) {
+			grid.push_back({x, y});
+		}
+	}
+	sets.push_back(grid);
+
+	std::mt19937 generator(5);
+	std::uniform_real_distribution<double> coordinate(-100.0, 100.0);
+	std::uniform_int_distribution<int> lattice(-4, 4);
+	for (size_t n = 3; n <= 60; ++n) {
+		PointSet uniform(n), coarse(n);
+		for (size_t i = 0; i < n; ++i) {
+			uniform[i] = {coordinate(generator), coordinate(generator)};
+			coarse[i] = {lattice(generator), lattice(generator)};
+		}
+		sets.push_back(uniform);
+		sets.push_back(coarse);
+	}
+
+	const auto agrees = [](const PointSet& points, const PointSet& triangle, double expected) {
+		const double area = triangleArea(triangle);
+		if (std::abs(area - expected) > 1e-12 * std::max(1.0, expected)) {
+			return false;
+		}
+		return area == 0 || std::all_of(triangle.begin(), triangle.end(), [&](const auto& vertex) {
+			return std::find(points.begin(), points.end(), vertex) != points.end();
+		});
+	};
+
+	size_t failures = 0;
+	for (const PointSet& points : sets) {
+		const double expected = triangleArea(bestTriangleReference(points));
+		const PointSet hull = maxAreaTriangleHull(points);
+		const PointSet scan = maxAreaTriangleBruteForce(points);
+		if (!agrees(points, hull, expected) || !agrees(points, scan, expected)) {
+			std::printf("  FAILED on %zu points: reference %.17g, hull %.17g, scan %.17g\n",
+				points.size(), expected, triangleArea(hull), triangleArea(scan));
+			++failures;
+		}
+	}
+	std::printf("  triangle: %zu sets, %zu failed\n", sets.size(), failures);
+	return failures == 0;
+}
+
+// Every evalPoly kernel the CPU has against evalPolyScalar, element by element,
+// for degrees 0 to 15 and every n up to well past the widest unrolled block,
+// so each tail length of each vector width is covered. The FMA kernels must
+// match bit for bit. SSE2 rounds the product separately and must stay within
+// 4 (d + 1) eps sum |c_k| |x|^(d-k), just over twice the Horner error bound.
+template<typename T>
+size_t checkEvalPoly(const char* type)
+{
+	const struct {
+		PolyKernel kernel;
+		const char* name;
+		bool fused;
+	} kernels[] = {
+		{PolyKernel::Avx512, "avx512", true},
+		{PolyKernel::Avx2, "avx2", true},
+		{PolyKernel::Sse2, "sse2", false},
+	};
+
+	std::mt19937 generator(6);
+	std::uniform_real_distribution<T> coefficient(T(-1), T(1));
+	std::uniform_real_distribution<T> position(T(-3), T(3));
+	constexpr size_t MaxN = 4 * 16 + 40;
+	std::vector<T> xs(MaxN), expected(MaxN), actual(MaxN);
+	for (T& x : xs) {
+		x = position(generator);
+	}
+
+	size_t failures = 0;
+	for (const auto& kernel : kernels) {
+		size_t compared = 0;
+		for (size_t terms = 1; terms <= 16; ++terms) {
+			std::vector<T> coeffs(terms);
+			for (T& c : coeffs) {
+				c = coefficient(generator);
+			}
+			for (size_t n = 0; n <= MaxN; ++n) {
+				const std::span<const T> in(xs.data(), n);
+				evalPolyScalar(coeffs, in, std::span<T>(expected.data(), n));
+				std::fill(actual.begin(), actual.end(), T(0));
+				if (!evalPolyWith(kernel.kernel, coeffs, in, std::span<T>(actual.data(), n))) {
+					break;
+				}
+				for (size_t i = 0; i < n; ++i) {
+					T magnitude = 0;
+					for (const T c : coeffs) {
+						magnitude = magnitude * std::abs(xs[i]) + std::abs(c);
+					}
+					const T bound = kernel.fused ? T(0) : T(4 * terms) * std::numeric_limits<T>::epsilon() * magnitude;
+					if (!(std::abs(actual[i] - expected[i]) <= bound)) {
+						if (failures++ < 10) {
+							std::printf("  FAILED %s %s, %zu terms, n = %zu, x[%zu] = %.9g: %.17g, reference %.17g\n",
+								kernel.name, type, terms, n, i, static_cast<double>(xs[i]), static_cast<double>(actual[i]), static_cast<double>(expected[i]));
+						}
+					}
+				}
+				++compared;
+			}
+		}
+		std::printf("  evalPoly %s %s: %s\n", kernel.name, type, compared > 0 ? "compared" : "not supported here");
+	}
+	return failures;
+}
+
+bool runChecks()
+{
+	std::printf("check: fast paths against their references\n");
+	const bool triangle = checkTriangle();
+	const size_t polyFailures = checkEvalPoly<double>("double") + checkEvalPoly<float>("float");
+	std::printf("  evalPoly: %zu values failed\n", polyFailures);
+	return triangle && polyFailures == 0;
+}
+
+// k curves on one n-point grid: one GEMM against a scalar Horner loop per
+// curve, as calculateParabolaPoints does, and against one SIMD evalPoly call
+// per curve.
+template<int Degree>
+void benchGrid(Eigen::Index n, Eigen::Index k)
+{
+	constexpr int Terms = Degree + 1;
+	std::vector<double> xs(static_cast<size_t>(n));
+	for (Eigen::Index i = 0; i < n; ++i) {
+		xs[i] = -10.0 + 20.0 * static_cast<double>(i) / static_cast<double>(n - 1);
+	}
+	std::mt19937 generator(static_cast<unsigned>(Degree * 1000 + k));
+	std::uniform_real_distribution<double> coefficient(-1.0, 1.0);
+	typename GridEvaluator<Degree>::CoeffMatrix C(Terms, k);
+	for (Eigen::Index j = 0; j < k; ++j) {
+		for (int t = 0; t < Terms; ++t) {
+			C(t, j) = coefficient(generator);
+		}
+	}
+
+	const GridEvaluator<Degree> evaluator(xs);
+	Eigen::MatrixXd Y(n, k);
+	const double gemm = bestMilliseconds(5, [&] {
+		evaluator.evaluateInto(C, Y);
+		sink += Y(n - 1, k - 1);
+	});
+
+	Eigen::MatrixXd Z(n, k);
+	const double horner = bestMilliseconds(5, [&] {
+		for (Eigen::Index j = 0; j < k; ++j) {
+			for (Eigen::Index i = 0; i < n; ++i) {
+				double y = C(0, j);
+				for (int t = 1; t < Terms; ++t) {
+					y = y * xs[i] + C(t, j);
+				}
+				Z(i, j) = y;
+			}
+		}
+		sink += Z(n - 1, k - 1);
+	});
+
+	const double simd = bestMilliseconds(5, [&] {
+		for (Eigen::Index j = 0; j < k; ++j) {
+			evalPoly(std::span<const double>(C.col(j).data(), Terms), xs, std::span<double>(Z.col(j).data(), static_cast<size_t>(n)));
+		}
+		sink += Z(n - 1, k - 1);
+	});
+
+	std::printf("  degree %d, n = %6td, k = %5td: GEMM %7.1f ms, Horner loops %7.1f ms, evalPoly %7.1f ms, max difference %.1e\n",
+		Degree, n, k, gemm, horner, simd, (Y - Z).cwiseAbs().maxCoeff() / Z.cwiseAbs().maxCoeff());
+}
+
+void benchGrid()
+{
+	std::printf("grid: many curves on a shared grid\n");
+	benchGrid<2>(2001, 4000);
+	benchGrid<3>(2001, 4000);
+	benchGrid<3>(100000, 64);
+	benchGrid<7>(2001, 4000);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	const auto wanted = [&](const char* name) {
+		if (argc < 2) {
+			return true;
+		}
+		for (int i = 1; i < argc; ++i) {
+			if (std::strcmp(argv[i], name) == 0) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	bool passed = true;
+	if (wanted("check")) passed = runChecks();
+	if (wanted("fitbatch")) benchFitBatch();
+	if (wanted("packs")) benchPacks();
+	if (wanted("mixed")) benchMixed();
+	if (wanted("triangle")) benchTriangle();
+	if (wanted("grid")) benchGrid();
+
+	std::printf("(checksum %g)\n", sink);
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <span>
+
+// ys[i] = sum_k coeffs[k] T_k(u_i), u_i = (2 xs[i] - (lo + hi)) / (hi - lo),
+// i.e. a Chebyshev series on [lo, hi], coefficients lowest order first.
+// Evaluation is Clenshaw's recurrence b_k = c_k + 2u b_(k+1) - b_(k+2) over as
+// many x per instruction as the CPU allows (AVX-512, AVX2 with FMA), picked
+// once at runtime like evalPoly. Every kernel rounds like evalChebyshevScalar,
+// so their results are bit-identical to it.
+// Clenshaw stays accurate in float across the whole interval, where monomial
+// Horner loses digits once the basis is badly conditioned; the float overload
+// processes twice as many x per instruction.
+// Only min(xs.size(), ys.size()) values are written; empty coeffs give 0.
+void evalChebyshev(std::span<const double> coeffs, double lo, double hi, std::span<const double> xs, std::span<double> ys);
+void evalChebyshev(std::span<const float> coeffs, float lo, float hi, std::span<const float> xs, std::span<float> ys);
+
+// Portable reference using std::fma.
+void evalChebyshevScalar(std::span<const double> coeffs, double lo, double hi, std::span<const double> xs, std::span<double> ys);
+void evalChebyshevScalar(std::span<const float> coeffs, float lo, float hi, std::span<const float> xs, std::span<float> ys);
@@ -1,5 +1,7 @@
 #pragma once
-#include <optional>
+#include <cstddef>
+#include <utility>
+#include <vector>
 
 class CoordinateIteration{
 private:
@@ -9,11 +11,12 @@ private:
 public: 
 	CoordinateIteration(const std::vector<std::pair<double, double>>& coords): coordinates(coords), currentIndex(0){}
 
-	std::optional<std::pair<double, double>> getNext() {
+	// Points into the vector instead of copying the point out; nullptr once every point has been visited.
+	const std::pair<double, double>* getNext() {
 		if(currentIndex < coordinates.size()) {
-			return coordinates[currentIndex++];
+			return &coordinates[currentIndex++];
 		} else {
-			return std::nullopt;
+			return nullptr;
 		}
 	}
 
@@ -0,0 +1,200 @@
+#pragma once
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <utility>
+#include <vector>
+#include "MaxAreaTriangle.h"
+#include "ThreadPool.h"
+
+// Result of an approximate search. triangle is made of input points and has
+// the given area; no triangle of input points is larger than upperBound.
+struct ApproximateTriangle {
+	PointSet triangle = PointSet(3);
+	double area = 0;
+	double upperBound = 0;
+
+	// Worst-case shortfall against the true maximum, as a fraction of it.
+	double relativeError() const { return upperBound > 0 ? 1.0 - area / upperBound : 0.0; }
+};
+
+// Extreme points of a point stream along k evenly spaced directions. This is
+// all an approximate max-area triangle needs: every hull vertex that matters
+// is within O(1/k^2) of the polygon they span. Points can be fed in chunks of
+// any size (for example as they are read from disk); each chunk is scanned in
+// parallel and only O(k) values are kept per thread, whatever the total count.
+class DirectionalCoreset {
+public:
+	using Point = std::pair<double, double>;
+
+	explicit DirectionalCoreset(size_t directions = 64)
+		: cosines(std::max<size_t>(directions, 3)), sines(cosines.size()), extremes(cosines.size())
+	{
+		for (size_t i = 0; i < cosines.size(); ++i) {
+			const double angle = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(cosines.size());
+			cosines[i] = std::cos(angle);
+			sines[i] = std::sin(angle);
+		}
+	}
+
+	void add(std::span<const Point> chunk, ThreadPool& pool = ThreadPool::shared())
+	{
+		const size_t k = cosines.size();
+		std::vector<Extreme> perThread(pool.size() * k);
+
+		pool.parallelFor(chunk.size(), Grain, [&](unsigned worker, size_t begin, size_t end) {
+			Extreme* best = perThread.data() + worker * k;
+			InnerCircle inner;
+
+			// Almost every point of a large cloud lies inside the disc, which
+			// costs three multiplications to rule out instead of k projections.
+			for (size_t j = begin; j < end; ++j) {
+				const Point& point = chunk[j];
+				if (inner.contains(point)) {
+					continue;
+				}
+				bool improved = false;
+				for (size_t i = 0; i < k; ++i) {
+					improved |= best[i].offer(cosines[i] * point.first + sines[i] * point.second, point);
+				}
+				if (improved) {
+					inner = InnerCircle(best, k);
+				}
+			}
+		});
+
+		for (size_t t = 0; t < pool.size(); ++t) {
+			for (size_t i = 0; i < k; ++i) {
+				extremes[i].offer(perThread[t * k + i]);
+			}
+		}
+	}
+
+	bool empty() const { return !extremes[0].valid(); }
+
+	// The distinct extreme points, at most k of them.
+	PointSet points() const
+	{
+		PointSet chosen;
+		for (const Extreme& extreme : extremes) {
+			if (extreme.valid()) chosen.push_back(extreme.point);
+		}
+		return chosen;
+	}
+
+	// Vertices of the intersection of the k supporting half-planes. It contains
+	// the hull of everything added, so no triangle of input points is larger
+	// than the largest triangle on these vertices.
+	PointSet outerPolygon() const
+	{
+		PointSet vertices;
+		if (empty()) {
+			return vertices;
+		}
+		const size_t k = cosines.size();
+		for (size_t i = 0; i < k; ++i) {
+			const size_t next = (i + 1) % k;
+			// Solve c_i x + s_i y = h_i and c_next x + s_next y = h_next.
+			const double determinant = cosines[i] * sines[next] - sines[i] * cosines[next];
+			const double x = (extremes[i].value * sines[next] - sines[i] * extremes[next].value) / determinant;
+			const double y = (cosines[i] * extremes[next].value - extremes[i].value * cosines[next]) / determinant;
+			vertices.push_back({x, y});
+		}
+		return vertices;
+	}
+
+	// Exact max-area triangle of the extreme points, with the bound from
+	// outerPolygon. The bound is exact up to rounding in the support values.
+	ApproximateTriangle maxAreaTriangle() const
+	{
+		ApproximateTriangle result;
+		result.triangle = maxAreaTriangleHull(points());
+		result.area = 0.5 * std::abs(cross(result.triangle[0], result.triangle[1], result.triangle[2]));
+
+		const PointSet bounding = maxAreaTriangleHull(outerPolygon());
+		result.upperBound = std::max(result.area, 0.5 * std::abs(cross(bounding[0], bounding[1], bounding[2])));
+		return result;
+	}
+
+private:
+	static constexpr size_t Grain = 1 << 14;
+
+	// Largest projection seen so far. Equal projections keep the smaller
+	// point, so the result does not depend on the order points arrive in.
+	struct Extreme {
+		double value = -std::numeric_limits<double>::infinity();
+		Point point{};
+
+		bool valid() const { return value != -std::numeric_limits<double>::infinity(); }
+
+		bool offer(double candidate, const Point& at)
+		{
+			if (candidate > value || (candidate == value && at < point)) {
+				value = candidate;
+				point = at;
+				return true;
+			}
+			return false;
+		}
+
+		void offer(const Extreme& other)
+		{
+			if (other.valid()) offer(other.value, other.point);
+		}
+	};
+
+	// A disc strictly inside the polygon of the current extremes, which are in
+	// counter-clockwise order by direction. A point inside it is strictly
+	// inside that polygon, so it cannot reach or beat any extreme.
+	struct InnerCircle {
+		double cx = 0, cy = 0;
+		double radiusSquared = -1;
+
+		InnerCircle() = default;
+
+		InnerCircle(const Extreme* extremes, size_t k)
+		{
+			for (size_t i = 0; i < k; ++i) {
+				if (!extremes[i].valid()) return;
+				cx += extremes[i].point.first / static_cast<double>(k);
+				cy += extremes[i].point.second / static_cast<double>(k);
+			}
+
+			double radius = std::numeric_limits<double>::infinity();
+			for (size_t i = 0; i < k; ++i) {
+				const Point& a = extremes[i].point;
+				const Point& b = extremes[(i + 1) % k].point;
+				const double length = std::hypot(b.first - a.first, b.second - a.second);
+				if (length > 0) {
+					radius = std::min(radius, cross(a, b, {cx, cy}) / length);
+				}
+			}
+			// Shrunk a little so rounding in the test never admits a boundary point.
+			if (radius > 0 && std::isfinite(radius)) {
+				radius *= 1.0 - 1e-9;
+				radiusSquared = radius * radius;
+			}
+		}
+
+		bool contains(const Point& p) const
+		{
+			const double dx = p.first - cx, dy = p.second - cy;
+			return dx * dx + dy * dy < radiusSquared;
+		}
+	};
+
+	std::vector<double> cosines;
+	std::vector<double> sines;
+	std::vector<Extreme> extremes;
+};
+
+// Approximate alternative to maxAreaTriangle for point clouds too large for
+// an exact hull. The shortfall is O(1/directions^2) of the true maximum, and the
+// returned upperBound says how large it can be for this input.
+inline ApproximateTriangle approximateMaxAreaTriangle(std::span<const std::pair<double, double>> points, size_t directions = 64, ThreadPool& pool = ThreadPool::shared())
+{
+	DirectionalCoreset coreset(directions);
+	coreset.add(points, pool);
+	return coreset.maxAreaTriangle();
+}
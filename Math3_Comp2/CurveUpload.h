@@ -0,0 +1,38 @@
+#pragma once
+#include <glad/glad.h>
+#include <span>
+#include <vector>
+#include "CurveSampler.h"
+
+// Samples p (coefficients highest power first) over [start, end] straight into
+// the vertex buffer `vbo`, `stride` floats per vertex (see sampleVertices).
+// The buffer is reallocated to the exact size and mapped for writing, so the
+// samples go from the evaluation kernel to the driver's memory in one step.
+// vbo is left bound to GL_ARRAY_BUFFER, ready for glVertexAttribPointer.
+// Returns the number of vertices written.
+inline size_t uploadCurve(GLuint vbo, std::span<const double> coeffs, double start, double end, double step, size_t stride, GLenum usage = GL_STATIC_DRAW, SamplingMode mode = SamplingMode::Horner)
+{
+	const size_t count = sampleCount(start, end, step);
+	const size_t floats = count * stride;
+	const GLsizeiptr bytes = static_cast<GLsizeiptr>(floats * sizeof(float));
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, usage);
+	if (count == 0) {
+		return 0;
+	}
+
+	void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped) {
+		sampleVertices(coeffs, start, step, std::span<float>(static_cast<float*>(mapped), floats), stride, ThreadPool::shared(), mode);
+		// GL_FALSE means the store was lost (e.g. a mode switch) and has to be written again.
+		if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE) {
+			return count;
+		}
+	}
+
+	std::vector<float> vertices(floats);
+	sampleVertices(coeffs, start, step, vertices, stride, ThreadPool::shared(), mode);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+	return count;
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Picks the Degree+1 points whose Vandermonde matrix (rows x^Degree, ..., x, 1,
+// as in createMatrix and addCoordinatesToMatrix) has the largest |det|, i.e.
+// the interpolation system that is best conditioned in the D-optimal sense.
+// The y values play no part.
+//
+// Two stages, both one parallel pass over the candidates per step:
+//  - Greedy: pivoted Gram-Schmidt. Each step picks the candidate whose row has
+//    the largest component orthogonal to the rows already picked, which is the
+//    pick that multiplies the volume (and so |det|) the most.
+//  - Fedorov exchange: with W = V^-1 for the current picks, swapping pick i for
+//    candidate j scales det(V) by (phi_j^T W)_i. The best swap is applied while
+//    it grows |det|, and W follows it with a Sherman-Morrison rank-1 update.
+// Rows are built in u = (x - center) / halfWidth, u in [-1, 1]. That changes
+// det(V) only by a constant factor, so the argmax is the same as in x.
+// Ties are broken towards the lowest index, so the result does not depend on
+// how the pool schedules the passes.
+template<int Degree>
+class DOptimalDesign {
+public:
+	static constexpr int Terms = Degree + 1;
+
+	// Indices of the chosen points. Fewer than Degree+1 are returned when the
+	// points do not have that many distinct x values.
+	static std::vector<size_t> selectIndices(const PointSet& points, ThreadPool& pool = ThreadPool::shared())
+	{
+		const size_t n = points.size();
+		if (n == 0) {
+			return {};
+		}
+
+		double lo = std::numeric_limits<double>::max();
+		double hi = std::numeric_limits<double>::lowest();
+		for (const auto& point : points) {
+			lo = std::min(lo, point.first);
+			hi = std::max(hi, point.first);
+		}
+		const double center = 0.5 * (lo + hi);
+		const double inverseHalfWidth = hi > lo ? 2.0 / (hi - lo) : 1.0;
+
+		std::vector<double> u(n);
+		std::vector<double> residual(n);
+		pool.parallelFor(n, Grain, [&](unsigned, size_t begin, size_t end) {
+			for (size_t j = begin; j < end; ++j) {
+				u[j] = (points[j].first - center) * inverseHalfWidth;
+				residual[j] = row(u[j]).squaredNorm();
+			}
+		});
+
+		std::vector<size_t> picks = greedy(u, residual, pool);
+		if (picks.size() == Terms) {
+			exchange(u, picks, pool);
+		}
+		std::sort(picks.begin(), picks.end());
+		return picks;
+	}
+
+	static PointSet select(const PointSet& points, ThreadPool& pool = ThreadPool::shared())
+	{
+		PointSet chosen;
+		for (size_t index : selectIndices(points, pool)) {
+			chosen.push_back(points[index]);
+		}
+		return chosen;
+	}
+
+private:
+	using Row = Eigen::Matrix<double, 1, Terms>;
+	using Square = Eigen::Matrix<double, Terms, Terms>;
+
+	static constexpr size_t Grain = 4096;
+
+	// An exchange has to grow |det| by more than this factor to be taken, which
+	// stops the loop from cycling between picks that are equal up to rounding.
+	static constexpr double ExchangeGain = 1.0 + 1e-9;
+	static constexpr int MaxExchanges = 64 * Terms;
+
+	struct Best {
+		double value = 0;
+		size_t index = 0;
+		int slot = 0;
+
+		bool betterThan(const Best& other) const
+		{
+			if (value != other.value) return value > other.value;
+			if (index != other.index) return index < other.index;
+			return slot < other.slot;
+		}
+	};
+
+	static Row row(double u)
+	{
+		Row phi;
+		PolyFit<Degree>::fillRow(phi, 0, u);
+		return phi;
+	}
+
+	static Best reduce(const std::vector<Best>& perThread)
+	{
+		Best best;
+		best.value = -1;
+		for (const Best& candidate : perThread) {
+			if (candidate.betterThan(best)) best = candidate;
+		}
+		return best;
+	}
+
+	// residual[j] holds |phi_j|^2 on entry. Each pass first removes the
+	// component along the newest basis vector, then looks for the next pick.
+	static std::vector<size_t> greedy(const std::vector<double>& u, std::vector<double>& residual, ThreadPool& pool)
+	{
+		const size_t n = u.size();
+		std::vector<size_t> picks;
+		Square basis = Square::Zero();
+		double tolerance = 0;
+
+		for (int k = 0; k < Terms; ++k) {
+			std::vector<Best> perThread(pool.size(), Best{-1, 0, 0});
+			pool.parallelFor(n, Grain, [&](unsigned worker, size_t begin, size_t end) {
+				Best& best = perThread[worker];
+				for (size_t j = begin; j < end; ++j) {
+					if (k > 0) {
+						const double along = row(u[j]).dot(basis.row(k - 1));
+						residual[j] = std::max(residual[j] - along * along, 0.0);
+					}
+					const Best candidate{residual[j], j, 0};
+					if (candidate.betterThan(best)) best = candidate;
+				}
+			});
+
+			// The running update leaves about eps * |phi|^2 of cancellation noise
+			// per basis vector, so a repeated x can still show a residual of that
+			// size; only residuals clearly above it count as a new direction.
+			const Best best = reduce(perThread);
+			if (k == 0) {
+				tolerance = 16 * Terms * std::numeric_limits<double>::epsilon() * best.value;
+			}
+			if (!(best.value > tolerance)) {
+				break;
+			}
+
+			// Orthogonalise twice; the residual norms above are only used to choose.
+			Row q = row(u[best.index]);
+			for (int pass = 0; pass < 2; ++pass) {
+				for (int m = 0; m < k; ++m) {
+					q -= q.dot(basis.row(m)) * basis.row(m);
+				}
+			}
+			basis.row(k) = q.normalized();
+			picks.push_back(best.index);
+		}
+		return picks;
+	}
+
+	static void exchange(const std::vector<double>& u, std::vector<size_t>& picks, ThreadPool& pool)
+	{
+		const size_t n = u.size();
+		Square V;
+		for (int i = 0; i < Terms; ++i) {
+			V.row(i) = row(u[picks[i]]);
+		}
+		Square W = V.partialPivLu().inverse();
+		if (!W.allFinite()) {
+			return;
+		}
+
+		for (int step = 0; step < MaxExchanges; ++step) {
+			std::vector<Best> perThread(pool.size(), Best{-1, 0, 0});
+			pool.parallelFor(n, Grain, [&](unsigned worker, size_t begin, size_t end) {
+				Best& best = perThread[worker];
+				for (size_t j = begin; j < end; ++j) {
+					const Row ratios = row(u[j]) * W;
+					for (int i = 0; i < Terms; ++i) {
+						const Best candidate{std::abs(ratios(i)), j, i};
+						if (candidate.betterThan(best)) best = candidate;
+					}
+				}
+			});
+
+			const Best best = reduce(perThread);
+			if (!(best.value > ExchangeGain)) {
+				break;
+			}
+
+			// Replacing row i of V by phi_j: V' = V + e_i d^T with d = phi_j - phi_i,
+			// and W' = W - (W e_i)(d^T W) / (1 + d^T W e_i). The denominator is
+			// (phi_j^T W)_i because phi_i^T W e_i = 1.
+			const int i = best.slot;
+			const Row phi = row(u[best.index]);
+			const Row d = phi - row(u[picks[i]]);
+			const double denominator = phi.dot(W.col(i));
+			const Eigen::Matrix<double, Terms, 1> column = W.col(i);
+			W -= column * (d * W) / denominator;
+			picks[i] = best.index;
+		}
+	}
+};
@@ -0,0 +1,281 @@
+#include "EvalPoly.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "CpuFeatures.h"
+
+namespace {
+
+	// Every kernel works on Unroll vectors at a time. Horner is one dependent
+	// chain per x, so independent vectors are what keeps the FMA units busy.
+	constexpr size_t Unroll = 4;
+
+	template<typename T>
+	void hornerScalar(const T* c, size_t terms, const T* xs, T* ys, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i) {
+			T y = c[0];
+			for (size_t k = 1; k < terms; ++k) {
+				y = std::fma(y, xs[i], c[k]);
+			}
+			ys[i] = y;
+		}
+	}
+
+	// Same as hornerScalar but with a separately rounded product, for the SSE2 tail.
+	template<typename T>
+	void hornerScalarUnfused(const T* c, size_t terms, const T* xs, T* ys, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i) {
+			T y = c[0];
+			for (size_t k = 1; k < terms; ++k) {
+				const T product = y * xs[i];
+				y = product + c[k];
+			}
+			ys[i] = y;
+		}
+	}
+
+	void scalarDouble(const double* c, size_t terms, const double* xs, double* ys, size_t n)
+	{
+		hornerScalar(c, terms, xs, ys, 0, n);
+	}
+
+	void scalarFloat(const float* c, size_t terms, const float* xs, float* ys, size_t n)
+	{
+		hornerScalar(c, terms, xs, ys, 0, n);
+	}
+
+#if CPU_X86
+	void sse2Double(const double* c, size_t terms, const double* xs, double* ys, size_t n)
+	{
+		constexpr size_t W = 2;
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m128d x[Unroll], y[Unroll];
+			for (size_t u = 0; u < Unroll; ++u) {
+				x[u] = _mm_loadu_pd(xs + i + u * W);
+				y[u] = _mm_set1_pd(c[0]);
+			}
+			for (size_t k = 1; k < terms; ++k) {
+				const __m128d ck = _mm_set1_pd(c[k]);
+				for (size_t u = 0; u < Unroll; ++u) y[u] = _mm_add_pd(_mm_mul_pd(y[u], x[u]), ck);
+			}
+			for (size_t u = 0; u < Unroll; ++u) _mm_storeu_pd(ys + i + u * W, y[u]);
+		}
+		hornerScalarUnfused(c, terms, xs, ys, i, n);
+	}
+
+	void sse2Float(const float* c, size_t terms, const float* xs, float* ys, size_t n)
+	{
+		constexpr size_t W = 4;
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m128 x[Unroll], y[Unroll];
+			for (size_t u = 0; u < Unroll; ++u) {
+				x[u] = _mm_loadu_ps(xs + i + u * W);
+				y[u] = _mm_set1_ps(c[0]);
+			}
+			for (size_t k = 1; k < terms; ++k) {
+				const __m128 ck = _mm_set1_ps(c[k]);
+				for (size_t u = 0; u < Unroll; ++u) y[u] = _mm_add_ps(_mm_mul_ps(y[u], x[u]), ck);
+			}
+			for (size_t u = 0; u < Unroll; ++u) _mm_storeu_ps(ys + i + u * W, y[u]);
+		}
+		hornerScalarUnfused(c, terms, xs, ys, i, n);
+	}
+
+	CPU_TARGET("avx2,fma") void avx2Double(const double* c, size_t terms, const double* xs, double* ys, size_t n)
+	{
+		constexpr size_t W = 4;
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m256d x[Unroll], y[Unroll];
+			for (size_t u = 0; u < Unroll; ++u) {
+				x[u] = _mm256_loadu_pd(xs + i + u * W);
+				y[u] = _mm256_set1_pd(c[0]);
+			}
+			for (size_t k = 1; k < terms; ++k) {
+				const __m256d ck = _mm256_set1_pd(c[k]);
+				for (size_t u = 0; u < Unroll; ++u) y[u] = _mm256_fmadd_pd(y[u], x[u], ck);
+			}
+			for (size_t u = 0; u < Unroll; ++u) _mm256_storeu_pd(ys + i + u * W, y[u]);
+		}
+		hornerScalar(c, terms, xs, ys, i, n);
+	}
+
+	CPU_TARGET("avx2,fma") void avx2Float(const float* c, size_t terms, const float* xs, float* ys, size_t n)
+	{
+		constexpr size_t W = 8;
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m256 x[Unroll], y[Unroll];
+			for (size_t u = 0; u < Unroll; ++u) {
+				x[u] = _mm256_loadu_ps(xs + i + u * W);
+				y[u] = _mm256_set1_ps(c[0]);
+			}
+			for (size_t k = 1; k < terms; ++k) {
+				const __m256 ck = _mm256_set1_ps(c[k]);
+				for (size_t u = 0; u < Unroll; ++u) y[u] = _mm256_fmadd_ps(y[u], x[u], ck);
+			}
+			for (size_t u = 0; u < Unroll; ++u) _mm256_storeu_ps(ys + i + u * W, y[u]);
+		}
+		hornerScalar(c, terms, xs, ys, i, n);
+	}
+
+	// The tail runs through one masked vector instead of a scalar loop.
+	CPU_TARGET("avx512f") void avx512Double(const double* c, size_t terms, const double* xs, double* ys, size_t n)
+	{
+		constexpr size_t W = 8;
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m512d x[Unroll], y[Unroll];
+			for (size_t u = 0; u < Unroll; ++u) {
+				x[u] = _mm512_loadu_pd(xs + i + u * W);
+				y[u] = _mm512_set1_pd(c[0]);
+			}
+			for (size_t k = 1; k < terms; ++k) {
+				const __m512d ck = _mm512_set1_pd(c[k]);
+				for (size_t u = 0; u < Unroll; ++u) y[u] = _mm512_fmadd_pd(y[u], x[u], ck);
+			}
+			for (size_t u = 0; u < Unroll; ++u) _mm512_storeu_pd(ys + i + u * W, y[u]);
+		}
+		for (; i < n; i += W) {
+			const __mmask8 mask = static_cast<__mmask8>(n - i >= W ? 0xff : (1u << (n - i)) - 1);
+			const __m512d x = _mm512_maskz_loadu_pd(mask, xs + i);
+			__m512d y = _mm512_set1_pd(c[0]);
+			for (size_t k = 1; k < terms; ++k) y = _mm512_fmadd_pd(y, x, _mm512_set1_pd(c[k]));
+			_mm512_mask_storeu_pd(ys + i, mask, y);
+		}
+	}
+
+	CPU_TARGET("avx512f") void avx512Float(const float* c, size_t terms, const float* xs, float* ys, size_t n)
+	{
+		constexpr size_t W = 16;
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m512 x[Unroll], y[Unroll];
+			for (size_t u = 0; u < Unroll; ++u) {
+				x[u] = _mm512_loadu_ps(xs + i + u * W);
+				y[u] = _mm512_set1_ps(c[0]);
+			}
+			for (size_t k = 1; k < terms; ++k) {
+				const __m512 ck = _mm512_set1_ps(c[k]);
+				for (size_t u = 0; u < Unroll; ++u) y[u] = _mm512_fmadd_ps(y[u], x[u], ck);
+			}
+			for (size_t u = 0; u < Unroll; ++u) _mm512_storeu_ps(ys + i + u * W, y[u]);
+		}
+		for (; i < n; i += W) {
+			const __mmask16 mask = static_cast<__mmask16>(n - i >= W ? 0xffff : (1u << (n - i)) - 1);
+			const __m512 x = _mm512_maskz_loadu_ps(mask, xs + i);
+			__m512 y = _mm512_set1_ps(c[0]);
+			for (size_t k = 1; k < terms; ++k) y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(c[k]));
+			_mm512_mask_storeu_ps(ys + i, mask, y);
+		}
+	}
+#endif
+
+	template<typename T>
+	using Kernel = void (*)(const T*, size_t, const T*, T*, size_t);
+
+	template<typename T>
+	Kernel<T> pickKernel(Kernel<T> avx512, Kernel<T> avx2, Kernel<T> sse2, Kernel<T> scalar)
+	{
+#if CPU_X86
+		const CpuFeatures& cpu = CpuFeatures::get();
+		if (cpu.avx512f) return avx512;
+		if (cpu.avx2 && cpu.fma) return avx2;
+		if (cpu.sse2) return sse2;
+#endif
+		return scalar;
+	}
+
+	// The requested kernel, or nullptr if the CPU cannot run it.
+	template<typename T>
+	Kernel<T> kernelFor(PolyKernel which, [[maybe_unused]] Kernel<T> avx512, [[maybe_unused]] Kernel<T> avx2, [[maybe_unused]] Kernel<T> sse2, Kernel<T> scalar)
+	{
+#if CPU_X86
+		const CpuFeatures& cpu = CpuFeatures::get();
+		switch (which) {
+		case PolyKernel::Avx512: return cpu.avx512f ? avx512 : nullptr;
+		case PolyKernel::Avx2: return cpu.avx2 && cpu.fma ? avx2 : nullptr;
+		case PolyKernel::Sse2: return cpu.sse2 ? sse2 : nullptr;
+		case PolyKernel::Scalar: return scalar;
+		}
+		return nullptr;
+#else
+		return which == PolyKernel::Scalar ? scalar : nullptr;
+#endif
+	}
+
+	template<typename T>
+	void run(Kernel<T> kernel, std::span<const T> coeffs, std::span<const T> xs, std::span<T> ys)
+	{
+		const size_t n = std::min(xs.size(), ys.size());
+		if (coeffs.empty()) {
+			std::fill_n(ys.begin(), n, T(0));
+			return;
+		}
+		kernel(coeffs.data(), coeffs.size(), xs.data(), ys.data(), n);
+	}
+
+}
+
+void evalPoly(std::span<const double> coeffs, std::span<const double> xs, std::span<double> ys)
+{
+#if CPU_X86
+	static const Kernel<double> kernel = pickKernel<double>(&avx512Double, &avx2Double, &sse2Double, &scalarDouble);
+#else
+	static const Kernel<double> kernel = &scalarDouble;
+#endif
+	run(kernel, coeffs, xs, ys);
+}
+
+void evalPoly(std::span<const float> coeffs, std::span<const float> xs, std::span<float> ys)
+{
+#if CPU_X86
+	static const Kernel<float> kernel = pickKernel<float>(&avx512Float, &avx2Float, &sse2Float, &scalarFloat);
+#else
+	static const Kernel<float> kernel = &scalarFloat;
+#endif
+	run(kernel, coeffs, xs, ys);
+}
+
+void evalPolyScalar(std::span<const double> coeffs, std::span<const double> xs, std::span<double> ys)
+{
+	run<double>(&scalarDouble, coeffs, xs, ys);
+}
+
+void evalPolyScalar(std::span<const float> coeffs, std::span<const float> xs, std::span<float> ys)
+{
+	run<float>(&scalarFloat, coeffs, xs, ys);
+}
+
+bool evalPolyWith(PolyKernel which, std::span<const double> coeffs, std::span<const double> xs, std::span<double> ys)
+{
+#if CPU_X86
+	const Kernel<double> kernel = kernelFor<double>(which, &avx512Double, &avx2Double, &sse2Double, &scalarDouble);
+#else
+	const Kernel<double> kernel = kernelFor<double>(which, nullptr, nullptr, nullptr, &scalarDouble);
+#endif
+	if (!kernel) {
+		return false;
+	}
+	run(kernel, coeffs, xs, ys);
+	return true;
+}
+
+bool evalPolyWith(PolyKernel which, std::span<const float> coeffs, std::span<const float> xs, std::span<float> ys)
+{
+#if CPU_X86
+	const Kernel<float> kernel = kernelFor<float>(which, &avx512Float, &avx2Float, &sse2Float, &scalarFloat);
+#else
+	const Kernel<float> kernel = kernelFor<float>(which, nullptr, nullptr, nullptr, &scalarFloat);
+#endif
+	if (!kernel) {
+		return false;
+	}
+	run(kernel, coeffs, xs, ys);
+	return true;
+}
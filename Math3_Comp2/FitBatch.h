@@ -0,0 +1,28 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Fits every point set independently and returns the coefficients in the same
+// order. The sets are spread over the pool in small chunks so the
+// work-stealing scheduler can balance sets of very different sizes.
+// PolyFit works entirely in fixed-size stack storage, so each worker's stack
+// frame is its scratch buffer and the loop itself never allocates. The only
+// allocation is the result vector, made once up front.
+template<int Degree>
+std::vector<typename PolyFit<Degree>::Coeffs> fitBatch(std::span<const PointSet> sets, ThreadPool& pool = ThreadPool::shared())
+{
+	using Coeffs = typename PolyFit<Degree>::Coeffs;
+
+	std::vector<Coeffs> results(sets.size());
+
+	constexpr size_t grain = 256;
+	pool.parallelFor(sets.size(), grain, [&](unsigned, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			results[i] = PolyFit<Degree>::fit(sets[i]);
+		}
+	});
+
+	return results;
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include "CpuFeatures.h"
+#include "EvalPoly.h"
+
+// Fixed-step sampling by forward differences. With the table
+// D_k = (k-th forward difference of p at the current x), one step is
+// D_0 += D_1, D_1 += D_2, ..., i.e. Degree additions per sample instead of a
+// full evaluation. Rounding errors in the table grow polynomially with the
+// number of steps, so the table is rebuilt from the polynomial every
+// reanchorInterval samples, which bounds the error independently of length.
+//
+// ForwardLanes sub-sequences are interleaved: lane l produces samples
+// i = anchor + l, anchor + l + ForwardLanes, ..., each lane with its own table
+// for step ForwardLanes * step. At every step the lanes hold consecutive
+// samples, so one vector addition per difference and one contiguous store
+// produce ForwardLanes outputs.
+
+// Higher degrees gain little over Horner and go through evalPoly instead.
+constexpr int MaxForwardDegree = 7;
+constexpr size_t ForwardLanes = 4;
+
+// Each lane advances reanchorInterval / ForwardLanes steps between anchors.
+// At 1024 the result stays within about 1e-12 of the Horner value, relative to
+// the size of the polynomial's terms, even at MaxForwardDegree.
+constexpr size_t DefaultReanchorInterval = 1024;
+
+// Surjections[j][k] = k! * S(j, k), the number of maps from j items onto k,
+// with S the Stirling numbers of the second kind. The k-th forward difference
+// of u^j at u = 0 with step H is Surjections[j][k] * H^j.
+struct ForwardDifferenceWeights {
+	double surjections[MaxForwardDegree + 1][MaxForwardDegree + 1] = {};
+
+	constexpr ForwardDifferenceWeights()
+	{
+		surjections[0][0] = 1;
+		for (int j = 1; j <= MaxForwardDegree; ++j) {
+			for (int k = 1; k <= j; ++k) {
+				surjections[j][k] = k * (surjections[j - 1][k] + surjections[j - 1][k - 1]);
+			}
+		}
+	}
+};
+
+// Forward-difference table for the lane starting at sample `first`, stepping
+// ForwardLanes samples at a time, written to column `lane` of table.
+// The table comes from the Taylor coefficients at the anchor rather than from
+// differencing sampled values, which would cancel away about one bit per
+// difference order before stepping even begins.
+inline void anchorForwardDifferences(const double* c, size_t terms, double start, double step, size_t first, double (*table)[ForwardLanes], size_t lane)
+{
+	static constexpr ForwardDifferenceWeights weights;
+
+	// taylor[j] = p^(j)(x0) / j!, lowest power first, by repeated synthetic division.
+	const double x0 = start + static_cast<double>(first) * step;
+	double taylor[MaxForwardDegree + 1];
+	for (size_t k = 0; k < terms; ++k) taylor[k] = c[k];
+	for (size_t j = 0; j + 1 < terms; ++j) {
+		for (size_t k = 1; k < terms - j; ++k) {
+			taylor[k] += taylor[k - 1] * x0;
+		}
+	}
+	std::reverse(taylor, taylor + terms);
+
+	const double H = static_cast<double>(ForwardLanes) * step;
+	double scaled[MaxForwardDegree + 1];
+	double power = 1;
+	for (size_t j = 0; j < terms; ++j) {
+		scaled[j] = taylor[j] * power;
+		power *= H;
+	}
+
+	for (size_t k = 0; k < terms; ++k) {
+		double difference = 0;
+		for (size_t j = terms; j-- > k;) {
+			difference += weights.surjections[j][k] * scaled[j];
+		}
+		table[k][lane] = difference;
+	}
+}
+
+// ys[j] = p(start + (first + j) * step), lanes written as plain loops for the
+// compiler to vectorize.
+inline void forwardDifferenceLanes(const double* c, size_t terms, double start, double step, size_t first, double* ys, size_t count, size_t interval)
+{
+	for (size_t anchor = 0; anchor < count; anchor += interval) {
+		const size_t stop = std::min(count, anchor + interval);
+		double table[MaxForwardDegree + 1][ForwardLanes];
+		for (size_t l = 0; l < ForwardLanes; ++l) {
+			anchorForwardDifferences(c, terms, start, step, first + anchor + l, table, l);
+		}
+
+		size_t i = anchor;
+		for (; i + ForwardLanes <= stop; i += ForwardLanes) {
+			for (size_t l = 0; l < ForwardLanes; ++l) ys[i + l] = table[0][l];
+			for (size_t k = 0; k + 1 < terms; ++k) {
+				for (size_t l = 0; l < ForwardLanes; ++l) table[k][l] += table[k + 1][l];
+			}
+		}
+		for (size_t l = 0; i + l < stop; ++l) ys[i + l] = table[0][l];
+	}
+}
+
+#if CPU_X86
+CPU_TARGET("avx2") inline void forwardDifferenceAvx2(const double* c, size_t terms, double start, double step, size_t first, double* ys, size_t count, size_t interval)
+{
+	for (size_t anchor = 0; anchor < count; anchor += interval) {
+		const size_t stop = std::min(count, anchor + interval);
+		alignas(32) double table[MaxForwardDegree + 1][ForwardLanes];
+		for (size_t l = 0; l < ForwardLanes; ++l) {
+			anchorForwardDifferences(c, terms, start, step, first + anchor + l, table, l);
+		}
+
+		__m256d d[MaxForwardDegree + 1];
+		for (size_t k = 0; k < terms; ++k) d[k] = _mm256_load_pd(table[k]);
+
+		size_t i = anchor;
+		for (; i + ForwardLanes <= stop; i += ForwardLanes) {
+			_mm256_storeu_pd(ys + i, d[0]);
+			for (size_t k = 0; k + 1 < terms; ++k) d[k] = _mm256_add_pd(d[k], d[k + 1]);
+		}
+		_mm256_store_pd(table[0], d[0]);
+		for (size_t l = 0; i + l < stop; ++l) ys[i + l] = table[0][l];
+	}
+}
+#endif
+
+// ys[j] = p(start + (first + j) * step) for every j in ys, coefficients
+// highest power first.
+inline void forwardDifferenceRange(std::span<const double> coeffs, double start, double step, size_t first, std::span<double> ys, size_t reanchorInterval = DefaultReanchorInterval)
+{
+	using Kernel = void (*)(const double*, size_t, double, double, size_t, double*, size_t, size_t);
+
+	static const Kernel kernel = [] {
+#if CPU_X86
+		if (CpuFeatures::get().avx2) return static_cast<Kernel>(&forwardDifferenceAvx2);
+#endif
+		return static_cast<Kernel>(&forwardDifferenceLanes);
+	}();
+
+	if (coeffs.empty() || coeffs.size() > MaxForwardDegree + 1) {
+		double xs[256];
+		for (size_t done = 0; done < ys.size(); done += 256) {
+			const size_t size = std::min<size_t>(256, ys.size() - done);
+			for (size_t j = 0; j < size; ++j) xs[j] = start + static_cast<double>(first + done + j) * step;
+			evalPoly(coeffs, std::span<const double>(xs, size), ys.subspan(done, size));
+		}
+		return;
+	}
+
+	const size_t interval = std::max(reanchorInterval, ForwardLanes);
+	kernel(coeffs.data(), coeffs.size(), start, step, first, ys.data(), ys.size(), interval);
+}
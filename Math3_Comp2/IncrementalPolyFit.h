@@ -0,0 +1,99 @@
+#pragma once
+#include <Eigen/Dense>
+#include <cstddef>
+#include "PolyFit.h"
+
+// Least-squares polynomial fit that follows a point set under single-point
+// edits. It keeps the normal equations (sum of phi * phi^T and phi * y, with
+// phi = [u^Degree, ..., u, 1]) instead of the points, so adding or removing a
+// point costs O(Degree^2) and refreshing the coefficients is one
+// (Degree+1)x(Degree+1) LDLT solve, independent of how many points are held.
+// u = x - origin, where origin is the first x seen. This keeps the sums from
+// mixing very different magnitudes when the data sits far from zero.
+template<int Degree, typename Scalar = double>
+class IncrementalPolyFit {
+public:
+	static constexpr int Terms = Degree + 1;
+
+	using Coeffs = typename PolyFit<Degree, Scalar>::Coeffs;
+
+	void addPoint(double x, double y)
+	{
+		if (count == 0) {
+			origin = static_cast<Scalar>(x);
+		}
+		accumulate(x, y, Scalar(1));
+		++count;
+	}
+
+	// The point must have been added before; the sums are reduced by exactly
+	// what addPoint put into them.
+	void removePoint(double x, double y)
+	{
+		if (count == 0) {
+			return;
+		}
+		accumulate(x, y, Scalar(-1));
+		if (--count == 0) {
+			clear();
+		}
+	}
+
+	// Replaces the accumulated state with the given points. Useful after a
+	// long run of removals, which slowly accumulate rounding error.
+	void rebuild(const PointSet& points)
+	{
+		clear();
+		for (const auto& point : points) {
+			addPoint(point.first, point.second);
+		}
+	}
+
+	void clear()
+	{
+		normal.setZero();
+		rhs.setZero();
+		count = 0;
+		origin = Scalar(0);
+		dirty = true;
+	}
+
+	size_t size() const { return count; }
+
+	// Highest power first, in the original x coordinates.
+	const Coeffs& coeffs() const
+	{
+		if (dirty) {
+			const Coeffs shifted = normal.ldlt().solve(rhs);
+			cached = PolyFit<Degree, Scalar>::translate(shifted, origin);
+			dirty = false;
+		}
+		return cached;
+	}
+
+private:
+	using Matrix = Eigen::Matrix<Scalar, Terms, Terms>;
+
+	void accumulate(double x, double y, Scalar sign)
+	{
+		Coeffs phi;
+		Scalar power = Scalar(1);
+		const Scalar u = static_cast<Scalar>(x) - origin;
+		for (int k = Degree; k >= 0; --k) {
+			phi(k) = power;
+			power *= u;
+		}
+
+		normal.template selfadjointView<Eigen::Lower>().rankUpdate(phi, sign);
+		rhs += (sign * static_cast<Scalar>(y)) * phi;
+		dirty = true;
+	}
+
+	Matrix normal = Matrix::Zero();
+	Coeffs rhs = Coeffs::Zero();
+	Scalar origin = Scalar(0);
+	size_t count = 0;
+
+	mutable Coeffs cached = Coeffs::Zero();
+	mutable bool dirty = true;
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include "CpuFeatures.h"
+#include "PolyFit.h"
+
+// Solves many exact Degree+1 point interpolation problems side by side, for
+// example the 3 corners of the largest triangle in the parabola task or the
+// 4 points of the cubic task. A pack holds PackLanes independent problems in
+// struct-of-arrays layout so each arithmetic instruction works on every lane
+// at once.
+// Coefficients come out highest power first, like PolyFit.
+// Lanes whose x values repeat have no unique solution and come out as inf/NaN.
+
+constexpr int PackLanes = 8;
+
+template<int Degree>
+struct InterpolationPack {
+	alignas(64) double x[Degree + 1][PackLanes];
+	alignas(64) double y[Degree + 1][PackLanes];
+};
+
+template<int Degree>
+struct CoeffPack {
+	alignas(64) double c[Degree + 1][PackLanes];
+};
+
+template<int Degree>
+void setLane(InterpolationPack<Degree>& pack, int lane, const PointSet& points)
+{
+	for (int k = 0; k <= Degree; ++k) {
+		pack.x[k][lane] = points[k].first;
+		pack.y[k][lane] = points[k].second;
+	}
+}
+
+template<int Degree>
+typename PolyFit<Degree>::Coeffs getLane(const CoeffPack<Degree>& pack, int lane)
+{
+	typename PolyFit<Degree>::Coeffs coeffs;
+	for (int k = 0; k <= Degree; ++k) {
+		coeffs(k) = pack.c[k][lane];
+	}
+	return coeffs;
+}
+
+// Each kernel builds Newton divided differences and then expands the Newton
+// form into monomial coefficients with nested multiplication: O(Degree^2)
+// operations per lane and no pivoting, since every system is a Vandermonde one.
+
+template<int Degree>
+void solvePacksScalar(const InterpolationPack<Degree>* packs, CoeffPack<Degree>* out, size_t count)
+{
+	constexpr int Terms = Degree + 1;
+	for (size_t p = 0; p < count; ++p) {
+		const auto& x = packs[p].x;
+		double c[Terms][PackLanes];
+		double m[Terms][PackLanes] = {};
+
+		for (int k = 0; k < Terms; ++k)
+			for (int l = 0; l < PackLanes; ++l)
+				c[k][l] = packs[p].y[k][l];
+
+		for (int j = 1; j < Terms; ++j)
+			for (int k = Degree; k >= j; --k)
+				for (int l = 0; l < PackLanes; ++l)
+					c[k][l] = (c[k][l] - c[k - 1][l]) / (x[k][l] - x[k - j][l]);
+
+		for (int l = 0; l < PackLanes; ++l)
+			m[0][l] = c[Degree][l];
+		for (int k = Degree - 1; k >= 0; --k) {
+			for (int t = Degree - k; t >= 1; --t)
+				for (int l = 0; l < PackLanes; ++l)
+					m[t][l] = m[t - 1][l] - x[k][l] * m[t][l];
+			for (int l = 0; l < PackLanes; ++l)
+				m[0][l] = c[k][l] - x[k][l] * m[0][l];
+		}
+
+		for (int t = 0; t < Terms; ++t)
+			for (int l = 0; l < PackLanes; ++l)
+				out[p].c[Degree - t][l] = m[t][l];
+	}
+}
+
+#if CPU_X86
+template<int Degree>
+CPU_TARGET("avx2,fma") void solvePacksAvx2(const InterpolationPack<Degree>* packs, CoeffPack<Degree>* out, size_t count)
+{
+	constexpr int Terms = Degree + 1;
+	for (size_t p = 0; p < count; ++p) {
+		for (int half = 0; half < PackLanes; half += 4) {
+			__m256d x[Terms], c[Terms], m[Terms];
+			for (int k = 0; k < Terms; ++k) {
+				x[k] = _mm256_load_pd(&packs[p].x[k][half]);
+				c[k] = _mm256_load_pd(&packs[p].y[k][half]);
+				m[k] = _mm256_setzero_pd();
+			}
+
+			for (int j = 1; j < Terms; ++j)
+				for (int k = Degree; k >= j; --k)
+					c[k] = _mm256_div_pd(_mm256_sub_pd(c[k], c[k - 1]), _mm256_sub_pd(x[k], x[k - j]));
+
+			m[0] = c[Degree];
+			for (int k = Degree - 1; k >= 0; --k) {
+				for (int t = Degree - k; t >= 1; --t)
+					m[t] = _mm256_fnmadd_pd(x[k], m[t], m[t - 1]);
+				m[0] = _mm256_fnmadd_pd(x[k], m[0], c[k]);
+			}
+
+			for (int t = 0; t < Terms; ++t)
+				_mm256_store_pd(&out[p].c[Degree - t][half], m[t]);
+		}
+	}
+}
+
+template<int Degree>
+CPU_TARGET("avx512f") void solvePacksAvx512(const InterpolationPack<Degree>* packs, CoeffPack<Degree>* out, size_t count)
+{
+	constexpr int Terms = Degree + 1;
+	for (size_t p = 0; p < count; ++p) {
+		__m512d x[Terms], c[Terms], m[Terms];
+		for (int k = 0; k < Terms; ++k) {
+			x[k] = _mm512_load_pd(packs[p].x[k]);
+			c[k] = _mm512_load_pd(packs[p].y[k]);
+			m[k] = _mm512_setzero_pd();
+		}
+
+		for (int j = 1; j < Terms; ++j)
+			for (int k = Degree; k >= j; --k)
+				c[k] = _mm512_div_pd(_mm512_sub_pd(c[k], c[k - 1]), _mm512_sub_pd(x[k], x[k - j]));
+
+		m[0] = c[Degree];
+		for (int k = Degree - 1; k >= 0; --k) {
+			for (int t = Degree - k; t >= 1; --t)
+				m[t] = _mm512_fnmadd_pd(x[k], m[t], m[t - 1]);
+			m[0] = _mm512_fnmadd_pd(x[k], m[0], c[k]);
+		}
+
+		for (int t = 0; t < Terms; ++t)
+			_mm512_store_pd(out[p].c[Degree - t], m[t]);
+	}
+}
+#endif
+
+// Picks the widest kernel the CPU supports on first use.
+template<int Degree>
+void solveInterpolationPacks(std::span<const InterpolationPack<Degree>> packs, std::span<CoeffPack<Degree>> out)
+{
+	using Kernel = void (*)(const InterpolationPack<Degree>*, CoeffPack<Degree>*, size_t);
+
+	static const Kernel kernel = [] {
+#if CPU_X86
+		const CpuFeatures& cpu = CpuFeatures::get();
+		if (cpu.avx512f) return static_cast<Kernel>(&solvePacksAvx512<Degree>);
+		if (cpu.avx2 && cpu.fma) return static_cast<Kernel>(&solvePacksAvx2<Degree>);
+#endif
+		return static_cast<Kernel>(&solvePacksScalar<Degree>);
+	}();
+
+	kernel(packs.data(), out.data(), std::min(packs.size(), out.size()));
+}
@@ -16,6 +16,15 @@
 #include "Shader.h"
 #include "Camera.h"
 #include "CoordinateIteration.h"
+#include "PolyFit.h"
+#include "IncrementalPolyFit.h"
+#include "MaxAreaTriangle.h"
+#include "DynamicMaxTriangle.h"
+#include "DOptimalDesign.h"
+#include "CurveSampler.h"
+#include "CurveUpload.h"
+#include "SampleViews.h"
+#include "PolyRoots.h"
 
 struct CallbackData {
     Shader* myShader;
@@ -46,13 +55,22 @@ std::vector<std::pair<double, double>> coordinates = {
 		{6, 4} //Point 3
 	};
 
-void addNewPoint(double x, double y);
+// Least-squares fit over everything in coordinates, kept current by addNewPoint and removePointByIndex.
+IncrementalPolyFit<2> liveFit;
+
+// Hull and largest triangle of coordinates, kept current the same way.
+DynamicMaxTriangle triangleTracker;
 
-void removePointByIndex(std::vector<std::pair<double, double>> coordinates, size_t index);
+// Vertex buffer of the displayed parabola, refilled from liveFit after every edit.
+unsigned int curveVBO = 0;
+GLsizei curveVertexCount = 0;
 
-double triangleArea(const std::pair<double, double>& p1, const std::pair<double, double>& p2, const std::pair<double, double>& p3);
+void addNewPoint(double x, double y);
 
-std::vector<std::pair<double, double>> bestTriangle(const std::vector<std::pair<double, double>>& coordinates);
+void removePointByIndex(size_t index);
+
+// Prints the parabola liveFit currently holds and uploads its samples into curveVBO.
+void showLiveFit();
 
 Eigen::MatrixXd addCoordinatesToMatrix(std::vector<std::pair<double, double>>& coordinates);
 
@@ -60,8 +78,6 @@ Eigen::MatrixXd createMatrix(std::vector<std::pair<double, double>>& coordinates
 
 Eigen::MatrixXd invertedMatrix(const Eigen::MatrixXd& matrix);
 
-Eigen::Vector3d findParabola(const Eigen::MatrixXd& coordinates);
-
 std::vector<std::pair<double, double>> calculateParabolaPoints(double a, double b, double c, double xStart, double xEnd, double xIncrement);
 
 std::string formatParabolaEquation(double a, double b, double c);
@@ -100,16 +116,16 @@ int main() {
 
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    std::vector<float> vertices;
-	
-
     Shader myShader("shader.vs", "shader.fs");
 
 	Eigen::MatrixXd startPoints = addCoordinatesToMatrix(pointsOnThePlane);
 
 	std::cout << "For the first task I chose these points:\n" << startPoints << ".\n" << std::endl;
 
-	auto bestCoords = bestTriangle(coordinates);
+	liveFit.rebuild(coordinates);
+	triangleTracker.rebuild(coordinates);
+
+	auto bestCoords = triangleTracker.best();
 
 	std::cout << "these are the chosen coordinates for our matrix:" << std::endl;
 
@@ -117,6 +133,11 @@ int main() {
 	while (auto coords = iter.getNext()) {
 		std::cout << " (" << coords->first << ", " << coords->second << ")" << std::endl;
 	}
+
+	std::cout << "the best conditioned choice (largest Vandermonde determinant) would be:" << std::endl;
+	for (const auto& point : DOptimalDesign<2>::select(coordinates)) {
+		std::cout << " (" << point.first << ", " << point.second << ")" << std::endl;
+	}
 	
 	Eigen::MatrixXd matrix = addCoordinatesToMatrix(bestCoords);
 	std::cout << "\nStart matrix:\n" << matrix << std::endl;
@@ -127,14 +148,15 @@ int main() {
 	Eigen::MatrixXd invertMatrix = invertedMatrix(matrix);
 	std::cout << "\nInverted matrix:\n" << invertMatrix << std::endl;
 
-	Eigen::Vector3d coeffs = findParabola(matrix);
+	const Eigen::Vector3d coeffs = liveFit.coeffs();
 	std::cout << "\nThe parabola coefficients are:\n";
     std::cout << "a: " << coeffs[0] << ", b: " << coeffs[1] << ", c: " << coeffs[2] << std::endl;
 
 	std::string equation = formatParabolaEquation(coeffs[0], coeffs[1], coeffs[2]);
 	std::cout << "\nThe parabola equation for this matrix is:\n"<< equation << std::endl;
 
-	std::vector<std::pair<double, double>> parabolaPoints = calculateParabolaPoints(coeffs[0], coeffs[1], coeffs[2], -10, 10, 1);
+	// Evaluated lazily as the output loop below reads them; nothing is stored.
+	const SampleView parabolaPoints = samples(std::span<const double>(coeffs.data(), coeffs.size()), -10, 10, 1);
 
 	std::ofstream outFile("parabola_points.txt");
 	if (!outFile) {
@@ -144,18 +166,26 @@ int main() {
 	
 	outFile << "\nThe parabola equation for this matrix is:\n" << equation << "\n";
 
-	std::cout << "Calculated points on the parabola:\n";
-    for (const auto& point : parabolaPoints) {
-        std::cout << "(" << point.first << ", " << point.second << ")\n";
-		float x = static_cast<float>(point.first);
-		float y = static_cast<float>(point.second);
-
-		vertices.push_back(x);
-		vertices.push_back(y);
-    }
+	std::cout << "\nx-intercepts:";
+	outFile << "\nx-intercepts:";
+	for (double root : realRoots<2>(coeffs)) {
+		std::cout << " " << root;
+		outFile << " " << root;
+	}
+	std::cout << "\nVertex:";
+	outFile << "\nVertex:";
+	for (const Extremum& extremum : extrema<2>(coeffs)) {
+		const char* kind = extremum.minimum ? " minimum" : " maximum";
+		std::cout << kind << " (" << extremum.x << ", " << extremum.y << ")";
+		outFile << kind << " (" << extremum.x << ", " << extremum.y << ")";
+	}
+	std::cout << "\n";
+	outFile << "\n";
 
+	std::cout << "Calculated points on the parabola:\n";
 	outFile << "Calculated points on the parabola:\n";
     for (const auto& point : parabolaPoints) {
+        std::cout << "(" << point.first << ", " << point.second << ")\n";
         outFile << "(" << point.first << ", " << point.second << ")\n";
     }
 
@@ -168,14 +198,14 @@ int main() {
     callbackData.myShader = &myShader;
     callbackData.myCamera = &camera;
 
-	unsigned int VBO, VAO;
+	unsigned int VAO;
 	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &curveVBO);
 
 	glBindVertexArray(VAO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	// Same samples as parabolaPoints, written by the sampler directly into the mapped VBO.
+	curveVertexCount = static_cast<GLsizei>(uploadCurve(curveVBO, std::span<const double>(coeffs.data(), coeffs.size()), -10, 10, 1, 2));
 
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
@@ -216,17 +246,17 @@ int main() {
 
 		glBindVertexArray(VAO);
 		
-		glDrawArrays(GL_LINE_STRIP, 0, vertices.size() / 2);
+		glDrawArrays(GL_LINE_STRIP, 0, curveVertexCount);
 
 		glPointSize(5.0f);
-		glDrawArrays(GL_POINTS, 0, vertices.size() / 2);
+		glDrawArrays(GL_POINTS, 0, curveVertexCount);
 
         glfwSwapBuffers(window);
         glfwPollEvents();	
 	}
 
     glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &curveVBO);
 	glfwTerminate();
 	return 0;
 
@@ -302,42 +332,33 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 void addNewPoint(double x, double y)
 {
 	coordinates.push_back({x, y});
+	liveFit.addPoint(x, y);
+	triangleTracker.insert({x, y});
+	showLiveFit();
 }
 
-void removePointByIndex(std::vector<std::pair<double, double>> coordinates, size_t index)
+void removePointByIndex(size_t index)
 {
 	if(index < coordinates.size()){
+		liveFit.removePoint(coordinates[index].first, coordinates[index].second);
+		triangleTracker.erase(coordinates[index]);
 		coordinates.erase(coordinates.begin() + index);
+		showLiveFit();
 	}
 }
 
-double triangleArea(const std::pair<double, double>& p1, const std::pair<double, double>& p2, const std::pair<double, double>& p3)
+void showLiveFit()
 {
-	double area = 0.5 * std::abs(p1.first * (p2.second - p3.second) + p2.first * (p3.second - p1.second) + p3.first * (p1.second - p2.second)); 
-
-	return area;
-}
-
-std::vector<std::pair<double, double>> bestTriangle(const std::vector<std::pair<double, double>>& coordinates)
-{
-	double maxArea = 0;
-	std::vector<std::pair<double, double>> bestCoords(3);
-
-	for(size_t i = 0; i < coordinates.size(); ++i){
-		for(size_t j = 0; j < coordinates.size(); ++j){
-			for(size_t k = 0; k < coordinates.size(); ++k){
-				double area = triangleArea(coordinates[i], coordinates[j], coordinates[k]);
-				if (area > maxArea) {
-					maxArea = area;
-					bestCoords = {coordinates[i], coordinates[j], coordinates[k]};
-				
-				}
-			}
-		}
+	// Below three points the parabola is not determined; the last one stays on screen.
+	if (liveFit.size() < 3) {
+		return;
+	}
+	const Eigen::Vector3d coeffs = liveFit.coeffs();
+	std::cout << "\nThe parabola equation for the current points is:\n" << formatParabolaEquation(coeffs[0], coeffs[1], coeffs[2]) << std::endl;
+	if (curveVBO != 0) {
+		curveVertexCount = static_cast<GLsizei>(uploadCurve(curveVBO, std::span<const double>(coeffs.data(), coeffs.size()), -10, 10, 1, 2));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
-
-
-	return bestCoords;
 }
 
 Eigen::MatrixXd addCoordinatesToMatrix(std::vector<std::pair<double, double>>& coordinates)
@@ -358,12 +379,7 @@ Eigen::MatrixXd createMatrix(std::vector<std::pair<double, double>>& coordinates
 	Eigen::MatrixXd A(coordinates.size(), 3);
 
 	for(int i = 0; i < coordinates.size(); ++i) {
-		double x = coordinates[i].first;
-		double y = coordinates[i].second;
-		A(i, 0) = x * x;
-		A(i, 1) = x;
-		A(i, 2) = 1;
-	
+		PolyFit<2>::fillRow(A, i, coordinates[i].first);
 	}
 
 
@@ -384,35 +400,10 @@ Eigen::MatrixXd invertedMatrix(const Eigen::MatrixXd& matrix)
 	return inverse;
 }
 
-Eigen::Vector3d findParabola(const Eigen::MatrixXd& coordinates)
-{
-	int n = coordinates.rows();
-	Eigen::MatrixXd A(n, 3);
-	Eigen::VectorXd b(n);
-
-	for (size_t i = 0; i < n; ++i) {
-		double x = coordinates(i, 0);
-		double y = coordinates(i, 1);
-		A(i, 0) = x * x;
-		A(i, 1) = x;
-		A(i, 2) = 1;
-		b(i) = y;
-	}
-
-	Eigen::Vector3d coeffs = A.colPivHouseholderQr().solve(b);
-
-	return coeffs;
-}
-
 std::vector<std::pair<double, double>> calculateParabolaPoints(double a, double b, double c, double xStart, double xEnd, double xIncrement)
 {
-	std::vector<std::pair<double, double>> points;
-
-	for(double x = xStart; x <= xEnd; x += xIncrement){
-		double y = a * x * x + b * x + c;
-		points.emplace_back(x, y);
-	}
-	return points;
+	const double coeffs[] = {a, b, c};
+	return samplePolynomial(coeffs, xStart, xEnd, xIncrement);
 }
 
 std::string formatParabolaEquation(double a, double b, double c)
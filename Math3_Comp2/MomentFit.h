@@ -0,0 +1,216 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <utility>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Least-squares fit for very large point counts that never forms the
+// n x (Degree+1) design matrix. One parallel pass over the points collects the
+// power sums sum(u^k) and sum(u^k * y); the fit is then a (Degree+1)x(Degree+1)
+// solve. Memory is O(Degree) per thread and the pass runs at memory bandwidth.
+//
+// Accuracy comes from three things:
+//  - every block of points is summed around its own mean x, so the powers
+//    never mix widely different magnitudes;
+//  - block totals are added into each thread's sums with compensated
+//    (Neumaier) summation;
+//  - the final normal equations are built around the global mean and scaled by
+//    the standard deviation of x, so the solved system is well conditioned.
+template<int Degree>
+class MomentFit {
+public:
+	static constexpr int Terms = Degree + 1;
+	static constexpr int Moments = 2 * Degree + 1;
+
+	using Coeffs = typename PolyFit<Degree>::Coeffs;
+
+	static Coeffs fit(std::span<const std::pair<double, double>> points, ThreadPool& pool = ThreadPool::shared())
+	{
+		std::vector<PowerSums> perThread(pool.size());
+
+		pool.parallelFor(points.size(), BlockPoints * 16, [&](unsigned worker, size_t begin, size_t end) {
+			for (size_t start = begin; start < end; start += BlockPoints) {
+				perThread[worker].add(sumBlock(points.subspan(start, std::min(BlockPoints, end - start))));
+			}
+		});
+
+		double count = 0;
+		double weightedCenter = 0;
+		for (const PowerSums& sums : perThread) {
+			count += sums.count;
+			weightedCenter += sums.count * sums.center;
+		}
+		if (count == 0) {
+			return Coeffs::Zero();
+		}
+
+		PowerSums total;
+		total.center = weightedCenter / count;
+		total.hasCenter = true;
+		for (const PowerSums& sums : perThread) {
+			total.add(sums);
+		}
+
+		return total.solve();
+	}
+
+private:
+	// Small enough that a block is still in L1 when it is read the second time.
+	static constexpr size_t BlockPoints = 1024;
+	static constexpr int Lanes = 4;
+
+	// Sums of powers of (x - center), with a running compensation term for each.
+	struct PowerSums {
+		double count = 0;
+		double center = 0;
+		bool hasCenter = false;
+		double s[Moments] = {};
+		double t[Terms] = {};
+		double sErr[Moments] = {};
+		double tErr[Terms] = {};
+
+		// Adds other, re-expressed around this->center. Re-centring uses
+		// sum((x - c')^k) = sum_j C(k, j) (c - c')^(k - j) sum((x - c)^j).
+		void add(const PowerSums& other)
+		{
+			if (other.count == 0) {
+				return;
+			}
+			if (!hasCenter) {
+				center = other.center;
+				hasCenter = true;
+			}
+
+			const double d = other.center - center;
+			double shiftedS[Moments];
+			double shiftedT[Terms];
+			shift(other.s, other.sErr, shiftedS, Moments, d);
+			shift(other.t, other.tErr, shiftedT, Terms, d);
+
+			count += other.count;
+			for (int k = 0; k < Moments; ++k) compensatedAdd(s[k], sErr[k], shiftedS[k]);
+			for (int k = 0; k < Terms; ++k) compensatedAdd(t[k], tErr[k], shiftedT[k]);
+		}
+
+		Coeffs solve() const
+		{
+			double variance = (s[2 % Moments] + sErr[2 % Moments]) / count;
+			if (Degree == 0 || !(variance > 0)) {
+				variance = 1;
+			}
+			const double scale = std::sqrt(variance);
+
+			// Moments of u = (x - center) / scale.
+			double su[Moments];
+			double tu[Terms];
+			double unit = 1;
+			for (int k = 0; k < Moments; ++k) {
+				su[k] = (s[k] + sErr[k]) * unit;
+				if (k < Terms) tu[k] = (t[k] + tErr[k]) * unit;
+				unit /= scale;
+			}
+
+			Eigen::Matrix<double, Terms, Terms> normal;
+			Coeffs rhs;
+			for (int a = 0; a < Terms; ++a) {
+				for (int b = 0; b < Terms; ++b) {
+					normal(a, b) = su[2 * Degree - a - b];
+				}
+				rhs(a) = tu[Degree - a];
+			}
+
+			Coeffs coeffs = normal.colPivHouseholderQr().solve(rhs);
+			unit = 1;
+			for (int k = Degree; k >= 0; --k) {
+				coeffs(k) *= unit;
+				unit /= scale;
+			}
+			return PolyFit<Degree>::translate(coeffs, center);
+		}
+
+	private:
+		static void shift(const double* sums, const double* errors, double* out, int size, double d)
+		{
+			for (int k = 0; k < size; ++k) {
+				double binomial = 1;
+				double power = 1;
+				double value = 0;
+				// j runs down from k so that binomial = C(k, j) and power = d^(k - j).
+				for (int j = k; j >= 0; --j) {
+					value += binomial * power * (sums[j] + errors[j]);
+					binomial = binomial * j / (k - j + 1);
+					power *= d;
+				}
+				out[k] = value;
+			}
+		}
+
+		static void compensatedAdd(double& sum, double& error, double value)
+		{
+			const double next = sum + value;
+			if (std::abs(sum) >= std::abs(value)) {
+				error += (sum - next) + value;
+			} else {
+				error += (value - next) + sum;
+			}
+			sum = next;
+		}
+	};
+
+	// Power sums of one block, taken around the block's own mean x. The
+	// accumulators are split into lanes so the compiler can keep Lanes points
+	// per vector register.
+	static PowerSums sumBlock(std::span<const std::pair<double, double>> block)
+	{
+		PowerSums sums;
+		sums.count = static_cast<double>(block.size());
+
+		double center = 0;
+		for (const auto& point : block) {
+			center += point.first;
+		}
+		center /= sums.count;
+		sums.center = center;
+
+		double s[Moments][Lanes] = {};
+		double t[Terms][Lanes] = {};
+
+		size_t i = 0;
+		for (; i + Lanes <= block.size(); i += Lanes) {
+			double u[Lanes], y[Lanes], power[Lanes];
+			for (int l = 0; l < Lanes; ++l) {
+				u[l] = block[i + l].first - center;
+				y[l] = block[i + l].second;
+				power[l] = 1;
+			}
+			for (int k = 0; k < Moments; ++k) {
+				for (int l = 0; l < Lanes; ++l) {
+					s[k][l] += power[l];
+					if (k < Terms) t[k][l] += power[l] * y[l];
+					power[l] *= u[l];
+				}
+			}
+		}
+		for (; i < block.size(); ++i) {
+			const double u = block[i].first - center;
+			double power = 1;
+			for (int k = 0; k < Moments; ++k) {
+				s[k][0] += power;
+				if (k < Terms) t[k][0] += power * block[i].second;
+				power *= u;
+			}
+		}
+
+		for (int k = 0; k < Moments; ++k) {
+			for (int l = 0; l < Lanes; ++l) sums.s[k] += s[k][l];
+		}
+		for (int k = 0; k < Terms; ++k) {
+			for (int l = 0; l < Lanes; ++l) sums.t[k] += t[k][l];
+		}
+		return sums;
+	}
+};
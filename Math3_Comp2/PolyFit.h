@@ -0,0 +1,188 @@
+#pragma once
+#include <Eigen/Dense>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+// The point list every fitter in this project works on.
+using PointSet = std::vector<std::pair<double, double>>;
+
+// Least-squares fit of a polynomial with a compile-time degree.
+// Coefficients are ordered highest power first, the same way Main.cpp prints
+// the parabola as (a, b, c) and the cubic as (a, b, c, d).
+// All matrices have a fixed column count and a bounded row count, so a fit
+// never allocates on the heap regardless of how many points it is given.
+template<int Degree, typename Scalar = double>
+class PolyFit {
+public:
+	static_assert(Degree >= 0, "PolyFit needs a non-negative degree");
+
+	static constexpr int Terms = Degree + 1;
+
+	// Number of rows handed to a single Householder QR.
+	static constexpr int BlockRows = 32;
+
+	using Coeffs = Eigen::Matrix<Scalar, Terms, 1>;
+
+	// One step of the fold in fit(): R stacked on the next rows of [A | b].
+	using BlockMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Terms + 1, Eigen::ColMajor, BlockRows + Terms + 1, Terms + 1>;
+
+	// Writes x^Degree, ..., x, 1 into row i of A using repeated multiplication.
+	template<typename Derived>
+	static void fillRow(Eigen::MatrixBase<Derived>& A, Eigen::Index i, Scalar x)
+	{
+		Scalar power = Scalar(1);
+		for (int k = Degree; k >= 0; --k) {
+			A(i, k) = power;
+			power *= x;
+		}
+	}
+
+	// Householder reduction of the block to upper-triangular form in place,
+	// one reflector per column. This is what HouseholderQR does on blocks this
+	// narrow, minus its blocked-update branch; that branch never runs here,
+	// yet instantiating it makes GCC warn inside Eigen's triangular kernels.
+	// ChebyshevFit folds its blocks with this as well.
+	static void triangularize(BlockMatrix& block)
+	{
+		const Eigen::Index rows = block.rows();
+		Eigen::Matrix<Scalar, 1, Terms + 1> workspace;
+		for (Eigen::Index k = 0; k <= Terms; ++k) {
+			Scalar tau;
+			Scalar beta;
+			block.col(k).tail(rows - k).makeHouseholderInPlace(tau, beta);
+			block(k, k) = beta;
+			block.bottomRightCorner(rows - k, Terms - k).applyHouseholderOnTheLeft(block.col(k).tail(rows - k - 1), tau, workspace.data());
+		}
+	}
+
+	// pointAt(i) must return something with .first (x) and .second (y).
+	template<typename PointAt>
+	static Coeffs fit(Eigen::Index n, PointAt pointAt)
+	{
+		// Exactly Terms points is interpolation, which needs no factorisation.
+		if (n == Terms) {
+			Coeffs p;
+			if (interpolate(pointAt, p)) {
+				return p;
+			}
+		}
+
+		if (n <= BlockRows) {
+			return fitSmall(n, pointAt);
+		}
+
+		// Fold the rows of [A | b] into its R factor one block at a time.
+		// Every step is a QR of [R; next block], which leaves the least-squares
+		// solution unchanged while keeping the working set on the stack.
+		AugmentedR R = AugmentedR::Zero();
+		BlockMatrix block;
+		for (Eigen::Index start = 0; start < n; start += BlockRows) {
+			const Eigen::Index count = std::min<Eigen::Index>(BlockRows, n - start);
+			block.resize(Terms + 1 + count, Terms + 1);
+			block.topRows(Terms + 1) = R;
+			for (Eigen::Index i = 0; i < count; ++i) {
+				const auto point = pointAt(start + i);
+				const Eigen::Index row = Terms + 1 + i;
+				fillRow(block, row, static_cast<Scalar>(point.first));
+				block(row, Terms) = static_cast<Scalar>(point.second);
+			}
+
+			triangularize(block);
+			R = block.template topRows<Terms + 1>().template triangularView<Eigen::Upper>();
+		}
+
+		const SquareMatrix upper = R.template topLeftCorner<Terms, Terms>();
+		return upper.colPivHouseholderQr().solve(R.col(Terms).template head<Terms>());
+	}
+
+	static Coeffs fit(const PointSet& points)
+	{
+		return fit(static_cast<Eigen::Index>(points.size()), [&](Eigen::Index i) { return points[i]; });
+	}
+
+	// The polynomial through the Terms points pointAt(0), ..., pointAt(Degree),
+	// by Newton's divided differences, O(Degree^2). Returns false, leaving p
+	// untouched, when two x coincide (or the result is not finite); fit() then
+	// solves the rank-deficient system by QR instead.
+	template<typename PointAt>
+	static bool interpolate(PointAt pointAt, Coeffs& p)
+	{
+		Scalar xs[Terms];
+		Scalar d[Terms];
+		for (int i = 0; i < Terms; ++i) {
+			const auto point = pointAt(i);
+			xs[i] = static_cast<Scalar>(point.first);
+			d[i] = static_cast<Scalar>(point.second);
+		}
+		for (int j = 1; j < Terms; ++j) {
+			for (int i = Degree; i >= j; --i) {
+				const Scalar gap = xs[i] - xs[i - j];
+				if (gap == 0) {
+					return false;
+				}
+				d[i] = (d[i] - d[i - 1]) / gap;
+			}
+		}
+
+		// Expand d_0 + (x - x_0)(d_1 + (x - x_1)(d_2 + ...)) from the inside
+		// out, lowest power first.
+		Scalar low[Terms] = {};
+		low[0] = d[Degree];
+		for (int k = Degree - 1; k >= 0; --k) {
+			for (int t = Degree; t >= 1; --t) {
+				low[t] = low[t - 1] - xs[k] * low[t];
+			}
+			low[0] = d[k] - xs[k] * low[0];
+		}
+
+		Coeffs result;
+		for (int t = 0; t < Terms; ++t) {
+			result(Degree - t) = low[t];
+		}
+		if (!result.allFinite()) {
+			return false;
+		}
+		p = result;
+		return true;
+	}
+
+	// Coefficients of q(x - origin), for fits done in coordinates shifted by origin.
+	static Coeffs translate(const Coeffs& q, Scalar origin)
+	{
+		// Horner on polynomials: low = low * (x - origin) + q(k), lowest power first.
+		Scalar low[Terms] = {};
+		for (int k = 0; k < Terms; ++k) {
+			for (int t = Degree; t >= 1; --t) {
+				low[t] = low[t - 1] - origin * low[t];
+			}
+			low[0] = q(k) - origin * low[0];
+		}
+
+		Coeffs p;
+		for (int t = 0; t < Terms; ++t) {
+			p(Degree - t) = low[t];
+		}
+		return p;
+	}
+
+private:
+	using SquareMatrix = Eigen::Matrix<Scalar, Terms, Terms>;
+	using AugmentedR = Eigen::Matrix<Scalar, Terms + 1, Terms + 1>;
+	using SmallDesignMatrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Terms, Eigen::ColMajor, BlockRows, Terms>;
+	using SmallVector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1, Eigen::ColMajor, BlockRows, 1>;
+
+	template<typename PointAt>
+	static Coeffs fitSmall(Eigen::Index n, PointAt pointAt)
+	{
+		SmallDesignMatrix A(n, Terms);
+		SmallVector b(n);
+		for (Eigen::Index i = 0; i < n; ++i) {
+			const auto point = pointAt(i);
+			fillRow(A, i, static_cast<Scalar>(point.first));
+			b(i) = static_cast<Scalar>(point.second);
+		}
+
+		return Eigen::ColPivHouseholderQR<SmallDesignMatrix>(A).solve(b);
+	}
+};
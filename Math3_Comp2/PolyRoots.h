@@ -0,0 +1,311 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <utility>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Real roots, extrema and intersections of fitted polynomials (coefficients
+// highest power first, as PolyFit returns them). Degrees up to three use
+// closed forms, higher degrees the eigenvalues of the companion matrix; every
+// root is then polished by Newton steps on the original polynomial.
+// A root of multiplicity m may be reported up to m times, or, when rounding
+// pushes a double root off the real axis, not at all.
+//
+// Results live in fixed-size storage sized by the degree, so a query never
+// allocates; the batch versions below run queries for many polynomials on the
+// pool, with the results vector as the only allocation.
+
+// At most N items, stored inline.
+template<typename T, int N>
+struct BoundedList {
+	std::array<T, N> items{};
+	int count = 0;
+
+	void push(const T& item) { items[count++] = item; }
+	const T* begin() const { return items.data(); }
+	const T* end() const { return items.data() + count; }
+	int size() const { return count; }
+	bool empty() const { return count == 0; }
+	const T& operator[](int i) const { return items[i]; }
+};
+
+template<int Degree>
+using RealRoots = BoundedList<double, Degree>;
+
+struct Extremum {
+	double x;
+	double y;
+	bool minimum;
+};
+
+template<int Degree>
+using Extrema = BoundedList<Extremum, (Degree > 1 ? Degree - 1 : 0)>;
+
+template<int Degree>
+using Intersections = BoundedList<std::pair<double, double>, Degree>;
+
+namespace PolyRootsDetail {
+	// Eigenvalues whose imaginary part is within this fraction of their
+	// magnitude count as real; a double root splits into a pair about
+	// sqrt(machine epsilon) apart.
+	constexpr double RealTolerance = 1e-7;
+
+	constexpr int NewtonSteps = 2;
+
+	inline double value(const double* c, int terms, double x)
+	{
+		double y = c[0];
+		for (int k = 1; k < terms; ++k) {
+			y = y * x + c[k];
+		}
+		return y;
+	}
+
+	// Newton steps that are only kept while they reduce |p|, so a root next
+	// to a flat stretch is never thrown away.
+	inline double polish(const double* c, int terms, double x)
+	{
+		for (int step = 0; step < NewtonSteps; ++step) {
+			double y = c[0];
+			double dy = 0;
+			for (int k = 1; k < terms; ++k) {
+				dy = dy * x + y;
+				y = y * x + c[k];
+			}
+			if (dy == 0 || !std::isfinite(y / dy)) {
+				break;
+			}
+			const double next = x - y / dy;
+			if (!(std::abs(value(c, terms, next)) < std::abs(y))) {
+				break;
+			}
+			x = next;
+		}
+		return x;
+	}
+
+	// b x + c = 0.
+	inline int linear(double b, double c, double* out)
+	{
+		if (b == 0) {
+			return 0;
+		}
+		out[0] = -c / b;
+		return 1;
+	}
+
+	// a x^2 + b x + c = 0 without cancellation: the root of larger magnitude
+	// comes from q = -(b + sign(b) sqrt(disc)) / 2, the other from c / q.
+	inline int quadratic(double a, double b, double c, double* out)
+	{
+		if (a == 0) {
+			return linear(b, c, out);
+		}
+		const double disc = std::fma(b, b, -4.0 * a * c);
+		if (disc < 0) {
+			return 0;
+		}
+		const double q = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+		if (q == 0) {
+			out[0] = out[1] = 0;
+			return 2;
+		}
+		out[0] = q / a;
+		out[1] = c / q;
+		return 2;
+	}
+
+	// a x^3 + b x^2 + c x + d = 0 through the depressed cubic t^3 + p t + q
+	// with x = t - b / (3a): the trigonometric form when all three roots are
+	// real, Cardano's formula (in its cancellation-free form) when one is.
+	inline int cubic(double a, double b, double c, double d, double* out)
+	{
+		if (a == 0) {
+			return quadratic(b, c, d, out);
+		}
+		const double B = b / a;
+		const double C = c / a;
+		const double D = d / a;
+		const double shift = B / 3.0;
+		const double p = C - B * shift;
+		const double q = (2.0 * shift * shift - C) * shift + D;
+
+		const double halfQ = 0.5 * q;
+		const double thirdP = p / 3.0;
+		const double disc = halfQ * halfQ + thirdP * thirdP * thirdP;
+
+		if (disc > 0) {
+			const double u = std::cbrt(-halfQ - std::copysign(std::sqrt(disc), halfQ));
+			out[0] = (u == 0 ? 0.0 : u - thirdP / u) - shift;
+			return 1;
+		}
+		if (p == 0) {
+			out[0] = out[1] = out[2] = -shift;
+			return 3;
+		}
+		const double r = std::sqrt(-thirdP);
+		const double phi = std::acos(std::clamp(-halfQ / (r * r * r), -1.0, 1.0)) / 3.0;
+		for (int k = 0; k < 3; ++k) {
+			out[k] = 2.0 * r * std::cos(phi - 2.0 * std::numbers::pi * k / 3.0) - shift;
+		}
+		return 3;
+	}
+
+	// Real eigenvalues of the companion matrix of the monic polynomial
+	// x^n + (c[1] / c[0]) x^(n-1) + ... + c[n] / c[0].
+	template<int MaxDegree>
+	int companion(const double* c, int terms, double* out)
+	{
+		using Matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MaxDegree, MaxDegree>;
+
+		const int n = terms - 1;
+		Matrix M = Matrix::Zero(n, n);
+		for (int j = 0; j < n; ++j) {
+			M(0, j) = -c[j + 1] / c[0];
+		}
+		for (int i = 1; i < n; ++i) {
+			M(i, i - 1) = 1;
+		}
+
+		const Eigen::EigenSolver<Matrix> solver(M, false);
+		if (solver.info() != Eigen::Success) {
+			return 0;
+		}
+		int count = 0;
+		for (Eigen::Index i = 0; i < solver.eigenvalues().size(); ++i) {
+			const std::complex<double> lambda = solver.eigenvalues()(i);
+			if (std::abs(lambda.imag()) <= RealTolerance * std::max(1.0, std::abs(lambda))) {
+				out[count++] = lambda.real();
+			}
+		}
+		return count;
+	}
+
+	// Real roots of the polynomial c[0] x^(terms-1) + ... + c[terms-1], sorted.
+	// Leading zeros lower the degree; the zero polynomial has no roots.
+	template<int MaxDegree>
+	int realRoots(const double* c, int terms, double* out)
+	{
+		while (terms > 0 && c[0] == 0) {
+			++c;
+			--terms;
+		}
+
+		int count = 0;
+		switch (terms - 1) {
+		case 1: count = linear(c[0], c[1], out); break;
+		case 2: count = quadratic(c[0], c[1], c[2], out); break;
+		case 3: count = cubic(c[0], c[1], c[2], c[3], out); break;
+		default:
+			if constexpr (MaxDegree > 3) {
+				if (terms > 4) count = companion<MaxDegree>(c, terms, out);
+			}
+			break;
+		}
+
+		for (int i = 0; i < count; ++i) {
+			out[i] = polish(c, terms, out[i]);
+		}
+		std::sort(out, out + count);
+		return count;
+	}
+}
+
+template<int Degree>
+RealRoots<Degree> realRoots(const typename PolyFit<Degree>::Coeffs& coeffs)
+{
+	RealRoots<Degree> roots;
+	if constexpr (Degree > 0) {
+		roots.count = PolyRootsDetail::realRoots<Degree>(coeffs.data(), Degree + 1, roots.items.data());
+	}
+	return roots;
+}
+
+// Points where p' changes sign, i.e. the vertex of a parabola or the local
+// minima and maxima of a cubic. Stationary points where p'' vanishes as
+// well, such as x = 0 on x^3, are inflections and are left out.
+template<int Degree>
+Extrema<Degree> extrema(const typename PolyFit<Degree>::Coeffs& coeffs)
+{
+	Extrema<Degree> result;
+	if constexpr (Degree > 1) {
+		// p' and p'' highest power first.
+		double first[Degree];
+		double second[Degree - 1];
+		for (int k = 0; k < Degree; ++k) {
+			first[k] = (Degree - k) * coeffs(k);
+		}
+		for (int k = 0; k < Degree - 1; ++k) {
+			second[k] = (Degree - 1 - k) * first[k];
+		}
+
+		double stationary[Degree - 1];
+		const int count = PolyRootsDetail::realRoots<Degree - 1>(first, Degree, stationary);
+		for (int i = 0; i < count; ++i) {
+			const double x = stationary[i];
+			const double curvature = PolyRootsDetail::value(second, Degree - 1, x);
+			if (curvature != 0) {
+				result.push({x, PolyRootsDetail::value(coeffs.data(), Degree + 1, x), curvature > 0});
+			}
+		}
+	}
+	return result;
+}
+
+// Points where p and q cross, found as the real roots of p - q. Identical
+// curves have no isolated intersections and report none.
+template<int Degree>
+Intersections<Degree> intersections(const typename PolyFit<Degree>::Coeffs& p, const typename PolyFit<Degree>::Coeffs& q)
+{
+	const typename PolyFit<Degree>::Coeffs difference = p - q;
+	Intersections<Degree> result;
+	for (double x : realRoots<Degree>(difference)) {
+		result.push({x, PolyRootsDetail::value(p.data(), Degree + 1, x)});
+	}
+	return result;
+}
+
+namespace PolyRootsDetail {
+	// Closed forms cost tens of nanoseconds per polynomial, so tasks are
+	// larger than fitBatch's.
+	constexpr size_t BatchGrain = 4096;
+
+	template<typename Result, typename Query>
+	std::vector<Result> runBatch(size_t count, Query query, ThreadPool& pool)
+	{
+		std::vector<Result> results(count);
+		pool.parallelFor(count, BatchGrain, [&](unsigned, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				results[i] = query(i);
+			}
+		});
+		return results;
+	}
+}
+
+template<int Degree>
+std::vector<RealRoots<Degree>> realRootsBatch(std::span<const typename PolyFit<Degree>::Coeffs> coeffs, ThreadPool& pool = ThreadPool::shared())
+{
+	return PolyRootsDetail::runBatch<RealRoots<Degree>>(coeffs.size(), [&](size_t i) { return realRoots<Degree>(coeffs[i]); }, pool);
+}
+
+template<int Degree>
+std::vector<Extrema<Degree>> extremaBatch(std::span<const typename PolyFit<Degree>::Coeffs> coeffs, ThreadPool& pool = ThreadPool::shared())
+{
+	return PolyRootsDetail::runBatch<Extrema<Degree>>(coeffs.size(), [&](size_t i) { return extrema<Degree>(coeffs[i]); }, pool);
+}
+
+// Intersections of p[i] with q[i] for every i < min(p.size(), q.size()).
+template<int Degree>
+std::vector<Intersections<Degree>> intersectionsBatch(std::span<const typename PolyFit<Degree>::Coeffs> p, std::span<const typename PolyFit<Degree>::Coeffs> q, ThreadPool& pool = ThreadPool::shared())
+{
+	return PolyRootsDetail::runBatch<Intersections<Degree>>(std::min(p.size(), q.size()), [&](size_t i) { return intersections<Degree>(p[i], q[i]); }, pool);
+}
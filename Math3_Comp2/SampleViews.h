@@ -0,0 +1,200 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <utility>
+#include "CurveSampler.h"
+#include "EvalPoly.h"
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Lazy, random-access views over curve samples and point coordinates. Nothing
+// is materialised: element i is computed (or located) when it is read, so a
+// consumer can walk 10^8 samples, jump to any index or hand sub-ranges to
+// different threads without an intermediate vector.
+//
+// Parallel consumers use forEachChunk, which works the same for both views.
+// StridedView's iterator refers to real elements and is a legacy
+// random-access iterator, so std::for_each(std::execution::par_unseq, ...)
+// accepts it as well. SampleView's iterator returns values rather than
+// references. C++20 ranges accept that for a random-access iterator, so
+// iterator_concept says so, but the legacy requirements the execution-policy
+// overloads are specified on do not, so its iterator_category is only
+// input_iterator_tag and those overloads are not an option for it.
+
+// Samples (x_i, p(x_i)) with x_i = start + i * step, as samplePolynomial
+// would produce them. Like std::span, the view refers to the coefficients and
+// does not own them.
+class SampleView : public std::ranges::view_interface<SampleView> {
+public:
+	class Iterator {
+	public:
+		using iterator_concept = std::random_access_iterator_tag;
+		using iterator_category = std::input_iterator_tag;
+		using value_type = std::pair<double, double>;
+		using difference_type = std::ptrdiff_t;
+		using reference = value_type;
+
+		Iterator() = default;
+		Iterator(const SampleView* view, difference_type index) : coeffs(view->coeffs), start(view->start), step(view->step), index(index) {}
+
+		value_type operator*() const { return at(index); }
+		value_type operator[](difference_type offset) const { return at(index + offset); }
+
+		Iterator& operator++() { ++index; return *this; }
+		Iterator operator++(int) { Iterator old = *this; ++index; return old; }
+		Iterator& operator--() { --index; return *this; }
+		Iterator operator--(int) { Iterator old = *this; --index; return old; }
+		Iterator& operator+=(difference_type offset) { index += offset; return *this; }
+		Iterator& operator-=(difference_type offset) { index -= offset; return *this; }
+
+		friend Iterator operator+(Iterator it, difference_type offset) { return it += offset; }
+		friend Iterator operator+(difference_type offset, Iterator it) { return it += offset; }
+		friend Iterator operator-(Iterator it, difference_type offset) { return it -= offset; }
+		friend difference_type operator-(const Iterator& a, const Iterator& b) { return a.index - b.index; }
+		friend bool operator==(const Iterator& a, const Iterator& b) { return a.index == b.index; }
+		friend auto operator<=>(const Iterator& a, const Iterator& b) { return a.index <=> b.index; }
+
+	private:
+		value_type at(difference_type i) const
+		{
+			const double x = sampleX(start, step, static_cast<size_t>(i));
+			double y = coeffs.empty() ? 0.0 : coeffs[0];
+			for (size_t k = 1; k < coeffs.size(); ++k) {
+				y = std::fma(y, x, coeffs[k]);
+			}
+			return {x, y};
+		}
+
+		std::span<const double> coeffs;
+		double start = 0;
+		double step = 0;
+		difference_type index = 0;
+	};
+
+	SampleView() = default;
+	SampleView(std::span<const double> coeffs, double start, double step, size_t count)
+		: coeffs(coeffs), start(start), step(step), count(count)
+	{
+	}
+
+	Iterator begin() const { return Iterator(this, 0); }
+	Iterator end() const { return Iterator(this, static_cast<std::ptrdiff_t>(count)); }
+	size_t size() const { return count; }
+
+	// Bulk access for consumers that pull the samples in chunks: fills xs and
+	// ys with samples first, first + 1, ... through the SIMD kernel.
+	void evaluate(size_t first, std::span<double> xs, std::span<double> ys) const
+	{
+		const size_t n = std::min(xs.size(), ys.size());
+		for (size_t i = 0; i < n; ++i) {
+			xs[i] = sampleX(start, step, first + i);
+		}
+		evalPoly(coeffs, xs.first(n), ys.first(n));
+	}
+
+private:
+	std::span<const double> coeffs;
+	double start = 0;
+	double step = 0;
+	size_t count = 0;
+};
+
+namespace std::ranges {
+	template<>
+	inline constexpr bool enable_borrowed_range<SampleView> = true;
+}
+
+// Samples of p (coefficients highest power first) over [start, end].
+inline SampleView samples(std::span<const double> coeffs, double start, double end, double step)
+{
+	return SampleView(coeffs, start, step, sampleCount(start, end, step));
+}
+
+// Every stride-th element of data starting at offset, e.g. the x (offset 0)
+// or y (offset 1) components of an interleaved vertex buffer.
+template<typename T>
+class StridedView : public std::ranges::view_interface<StridedView<T>> {
+public:
+	class Iterator {
+	public:
+		using iterator_concept = std::random_access_iterator_tag;
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::remove_cv_t<T>;
+		using difference_type = std::ptrdiff_t;
+		using reference = T&;
+
+		Iterator() = default;
+		Iterator(T* base, difference_type stride, difference_type index) : base(base), stride(stride), index(index) {}
+
+		T& operator*() const { return base[index * stride]; }
+		T& operator[](difference_type offset) const { return base[(index + offset) * stride]; }
+
+		Iterator& operator++() { ++index; return *this; }
+		Iterator operator++(int) { Iterator old = *this; ++index; return old; }
+		Iterator& operator--() { --index; return *this; }
+		Iterator operator--(int) { Iterator old = *this; --index; return old; }
+		Iterator& operator+=(difference_type offset) { index += offset; return *this; }
+		Iterator& operator-=(difference_type offset) { index -= offset; return *this; }
+
+		friend Iterator operator+(Iterator it, difference_type offset) { return it += offset; }
+		friend Iterator operator+(difference_type offset, Iterator it) { return it += offset; }
+		friend Iterator operator-(Iterator it, difference_type offset) { return it -= offset; }
+		friend difference_type operator-(const Iterator& a, const Iterator& b) { return a.index - b.index; }
+		friend bool operator==(const Iterator& a, const Iterator& b) { return a.index == b.index; }
+		friend auto operator<=>(const Iterator& a, const Iterator& b) { return a.index <=> b.index; }
+
+	private:
+		// Kept as an index so the end iterator never forms a pointer past the buffer.
+		T* base = nullptr;
+		difference_type stride = 1;
+		difference_type index = 0;
+	};
+
+	StridedView() = default;
+	StridedView(std::span<T> data, size_t offset, size_t stride)
+		: first(data.size() > offset ? data.data() + offset : nullptr),
+		  stride(static_cast<std::ptrdiff_t>(stride)),
+		  count(data.size() > offset ? (data.size() - offset + stride - 1) / stride : 0)
+	{
+	}
+
+	Iterator begin() const { return Iterator(first, stride, 0); }
+	Iterator end() const { return Iterator(first, stride, static_cast<std::ptrdiff_t>(count)); }
+	size_t size() const { return count; }
+
+private:
+	T* first = nullptr;
+	std::ptrdiff_t stride = 1;
+	size_t count = 0;
+};
+
+namespace std::ranges {
+	template<typename T>
+	inline constexpr bool enable_borrowed_range<StridedView<T>> = true;
+}
+
+template<typename T>
+StridedView<T> strided(std::span<T> data, size_t offset, size_t stride)
+{
+	return StridedView<T>(data, offset, stride);
+}
+
+// The x and y coordinates of a point set as random-access views.
+inline auto pointXs(const PointSet& points) { return std::views::keys(points); }
+inline auto pointYs(const PointSet& points) { return std::views::values(points); }
+
+// Calls body(chunk) on consecutive sub-ranges of view spread over the pool,
+// grain elements or so each. A chunk is a std::ranges::subrange of the view's
+// own iterators; chunk.begin() - view.begin() is the index of its first
+// element, e.g. for SampleView::evaluate.
+template<typename View, typename Body>
+void forEachChunk(const View& view, ThreadPool& pool, Body body, size_t grain = 1 << 14)
+{
+	const auto first = view.begin();
+	pool.parallelFor(view.size(), grain, [&](unsigned, size_t begin, size_t end) {
+		body(std::ranges::subrange(first + static_cast<std::ptrdiff_t>(begin), first + static_cast<std::ptrdiff_t>(end)));
+	});
+}
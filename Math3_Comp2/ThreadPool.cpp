@@ -0,0 +1,138 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+	thread_local bool insidePool = false;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+	threadCount = std::max(threadCount, 1u);
+	ranges = std::make_unique<ChunkRange[]>(threadCount);
+
+	workers.reserve(threadCount - 1);
+	for (unsigned i = 1; i < threadCount; ++i) {
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+ThreadPool& ThreadPool::shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const RangeBody& body)
+{
+	if (count == 0) {
+		return;
+	}
+	grain = std::max<size_t>(grain, 1);
+
+	const size_t chunks = (count + grain - 1) / grain;
+	if (insidePool || workers.empty() || chunks == 1) {
+		body(0, 0, count);
+		return;
+	}
+
+	std::lock_guard<std::mutex> call(callMutex);
+
+	const unsigned threads = size();
+	for (unsigned i = 0; i < threads; ++i) {
+		ranges[i].next.store(chunks * i / threads, std::memory_order_relaxed);
+		ranges[i].end = chunks * (i + 1) / threads;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		currentBody = &body;
+		currentCount = count;
+		currentGrain = grain;
+		firstError = nullptr;
+		busyWorkers = static_cast<unsigned>(workers.size());
+		++generation;
+	}
+	wake.notify_all();
+
+	insidePool = true;
+	runChunks(0);
+	insidePool = false;
+
+	std::unique_lock<std::mutex> lock(stateMutex);
+	finished.wait(lock, [this] { return busyWorkers == 0; });
+	currentBody = nullptr;
+
+	if (firstError) {
+		std::rethrow_exception(firstError);
+	}
+}
+
+void ThreadPool::workerLoop(unsigned worker)
+{
+	insidePool = true;
+	size_t seenGeneration = 0;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(stateMutex);
+			wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+			if (stopping) {
+				return;
+			}
+			seenGeneration = generation;
+		}
+
+		runChunks(worker);
+
+		std::lock_guard<std::mutex> lock(stateMutex);
+		if (--busyWorkers == 0) {
+			finished.notify_one();
+		}
+	}
+}
+
+bool ThreadPool::claimChunk(ChunkRange& range, size_t& chunk)
+{
+	if (range.next.load(std::memory_order_relaxed) >= range.end) {
+		return false;
+	}
+	chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+	return chunk < range.end;
+}
+
+void ThreadPool::runChunks(unsigned worker)
+{
+	const unsigned threads = size();
+	size_t chunk = 0;
+
+	// Own run first, then walk the other runs and steal from their fronts.
+	for (unsigned offset = 0; offset < threads; ++offset) {
+		ChunkRange& range = ranges[(worker + offset) % threads];
+		while (claimChunk(range, chunk)) {
+			const size_t begin = chunk * currentGrain;
+			const size_t end = std::min(begin + currentGrain, currentCount);
+			try {
+				(*currentBody)(worker, begin, end);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!firstError) {
+					firstError = std::current_exception();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// parallelFor splits [0, count) into chunks and deals each worker an equal
+// run of them up front. A worker that finishes its own run steals chunks from
+// the other runs, so uneven chunk costs still keep every core busy.
+class ThreadPool
+{
+public:
+	// Called as body(worker, begin, end). worker is in [0, size()) and is
+	// unique among the threads running concurrently, so it can index
+	// per-thread scratch storage.
+	using RangeBody = std::function<void(unsigned, size_t, size_t)>;
+
+	explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Number of threads taking part in a parallelFor, the caller included.
+	unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+	// Blocks until every chunk has run. Calls from inside a body run serially
+	// on the calling thread. The first exception thrown by a body is
+	// rethrown here once the loop has drained.
+	void parallelFor(size_t count, size_t grain, const RangeBody& body);
+
+	// Process-wide pool sized to the machine.
+	static ThreadPool& shared();
+
+private:
+	struct alignas(64) ChunkRange {
+		std::atomic<size_t> next{0};
+		size_t end = 0;
+	};
+
+	void workerLoop(unsigned worker);
+	void runChunks(unsigned worker);
+	bool claimChunk(ChunkRange& range, size_t& chunk);
+
+	std::vector<std::thread> workers;
+	std::unique_ptr<ChunkRange[]> ranges;
+
+	std::mutex callMutex;
+	std::mutex stateMutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	size_t generation = 0;
+	unsigned busyWorkers = 0;
+	bool stopping = false;
+
+	const RangeBody* currentBody = nullptr;
+	size_t currentCount = 0;
+	size_t currentGrain = 1;
+	std::exception_ptr firstError;
+	std::mutex errorMutex;
+};
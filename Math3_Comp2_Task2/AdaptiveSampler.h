@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <vector>
+#include "PolyFit.h"
+
+// Polyline sampling with as few vertices as a visual tolerance allows.
+// Between two samples h apart, the chord differs from the curve by at most
+// h^2 / 8 * max|p''| over the segment. Each step is made as long as that bound
+// allows: flat stretches get a few long segments, tight bends many short ones.
+// The deviation is measured vertically, which is never less than the distance
+// to the curve, so the on-screen error is within the tolerance as well.
+
+// World-space length one pixel covers at `distance` in front of a perspective
+// camera with vertical field of view fovYDegrees (Camera::Zoom) and a
+// viewport viewportHeight pixels high.
+inline double worldUnitsPerPixel(double fovYDegrees, double distance, double viewportHeight)
+{
+	const double visibleHeight = 2.0 * distance * std::tan(0.5 * fovYDegrees * std::numbers::pi / 180.0);
+	return visibleHeight / viewportHeight;
+}
+
+// Samples p (coefficients highest power first) over [start, end] so that the
+// polyline stays within `tolerance` world units of the curve. Both ends are
+// always included. Returns no points unless tolerance is positive.
+inline PointSet sampleAdaptive(std::span<const double> coeffs, double start, double end, double tolerance)
+{
+	PointSet points;
+	if (!(end >= start) || coeffs.empty() || !(tolerance > 0)) {
+		return points;
+	}
+
+	const size_t terms = coeffs.size();
+	const auto value = [&](double x) {
+		double y = coeffs[0];
+		for (size_t k = 1; k < terms; ++k) {
+			y = y * x + coeffs[k];
+		}
+		return y;
+	};
+
+	// p'' highest power first: the term c_k x^n, n = terms - 1 - k, becomes
+	// n (n - 1) c_k x^(n - 2).
+	std::vector<double> second;
+	for (size_t k = 0; k + 2 < terms; ++k) {
+		const double n = static_cast<double>(terms - 1 - k);
+		second.push_back(n * (n - 1) * coeffs[k]);
+	}
+
+	// Upper bound of |p''| on [a, b]: with t_j the Taylor coefficients of p''
+	// at the midpoint and r the half width, |p''| <= sum |t_j| r^j.
+	std::vector<double> taylor(second.size());
+	const auto secondDerivativeBound = [&](double a, double b) {
+		if (second.empty()) {
+			return 0.0;
+		}
+		const double mid = 0.5 * (a + b);
+		std::copy(second.begin(), second.end(), taylor.begin());
+		for (size_t j = 0; j + 1 < taylor.size(); ++j) {
+			for (size_t k = 1; k < taylor.size() - j; ++k) {
+				taylor[k] += taylor[k - 1] * mid;
+			}
+		}
+		// taylor is now highest-order coefficient first.
+		const double r = 0.5 * (b - a);
+		double bound = 0;
+		for (double t : taylor) {
+			bound = bound * r + std::abs(t);
+		}
+		return bound;
+	};
+
+	// Guards against an endless loop on a tolerance too small to resolve.
+	const double minimumStep = std::max((end - start) * 1e-9, std::abs(start) * 1e-15);
+	const double chordLimit = 8.0 * tolerance;
+	const auto fits = [&](double x, double h) { return secondDerivativeBound(x, x + h) * h * h <= chordLimit; };
+
+	double x = start;
+	points.push_back({x, value(x)});
+	while (x < end) {
+		const double remaining = end - x;
+		double h = remaining;
+
+		if (!fits(x, remaining)) {
+			// Bracket the longest step that fits, starting from what the
+			// curvature at x alone would allow, then narrow it down.
+			const double local = secondDerivativeBound(x, x);
+			double good = 0;
+			double bad = remaining;
+			// Not std::clamp: remaining drops below minimumStep on most last steps.
+			double guess = std::min(std::max(local > 0 ? std::sqrt(chordLimit / local) : remaining, minimumStep), remaining);
+			while (guess > minimumStep && !fits(x, guess)) {
+				bad = guess;
+				guess *= 0.5;
+			}
+			good = guess;
+			while (2 * good < bad && fits(x, 2 * good)) {
+				good *= 2;
+			}
+			bad = std::min(bad, 2 * good);
+			for (int refine = 0; refine < 8; ++refine) {
+				const double middle = 0.5 * (good + bad);
+				if (fits(x, middle)) good = middle;
+				else bad = middle;
+			}
+			h = std::max(good, minimumStep);
+		}
+
+		x = h >= remaining ? end : x + h;
+		points.push_back({x, value(x)});
+	}
+	return points;
+}
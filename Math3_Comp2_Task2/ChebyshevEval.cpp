@@ -0,0 +1,246 @@
+#include "ChebyshevEval.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "CpuFeatures.h"
+
+namespace {
+
+	// Independent vectors in flight per kernel iteration; each x is one
+	// dependent chain through the recurrence, as in evalPoly.
+	constexpr size_t Unroll = 4;
+
+	template<typename T>
+	void clenshawScalar(const T* c, size_t terms, T scale, T offset, const T* xs, T* ys, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i) {
+			const T u = std::fma(xs[i], scale, offset);
+			const T u2 = u + u;
+			T b1 = 0;
+			T b2 = 0;
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const T b = std::fma(u2, b1, c[k] - b2);
+				b2 = b1;
+				b1 = b;
+			}
+			ys[i] = std::fma(u, b1, c[0] - b2);
+		}
+	}
+
+	void scalarDouble(const double* c, size_t terms, double scale, double offset, const double* xs, double* ys, size_t n)
+	{
+		clenshawScalar(c, terms, scale, offset, xs, ys, 0, n);
+	}
+
+	void scalarFloat(const float* c, size_t terms, float scale, float offset, const float* xs, float* ys, size_t n)
+	{
+		clenshawScalar(c, terms, scale, offset, xs, ys, 0, n);
+	}
+
+#if CPU_X86
+	CPU_TARGET("avx2,fma") void avx2Double(const double* c, size_t terms, double scale, double offset, const double* xs, double* ys, size_t n)
+	{
+		constexpr size_t W = 4;
+		const __m256d s = _mm256_set1_pd(scale);
+		const __m256d o = _mm256_set1_pd(offset);
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m256d u[Unroll], u2[Unroll], b1[Unroll], b2[Unroll];
+			for (size_t v = 0; v < Unroll; ++v) {
+				u[v] = _mm256_fmadd_pd(_mm256_loadu_pd(xs + i + v * W), s, o);
+				u2[v] = _mm256_add_pd(u[v], u[v]);
+				b1[v] = _mm256_setzero_pd();
+				b2[v] = _mm256_setzero_pd();
+			}
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const __m256d ck = _mm256_set1_pd(c[k]);
+				for (size_t v = 0; v < Unroll; ++v) {
+					const __m256d b = _mm256_fmadd_pd(u2[v], b1[v], _mm256_sub_pd(ck, b2[v]));
+					b2[v] = b1[v];
+					b1[v] = b;
+				}
+			}
+			const __m256d c0 = _mm256_set1_pd(c[0]);
+			for (size_t v = 0; v < Unroll; ++v) {
+				_mm256_storeu_pd(ys + i + v * W, _mm256_fmadd_pd(u[v], b1[v], _mm256_sub_pd(c0, b2[v])));
+			}
+		}
+		clenshawScalar(c, terms, scale, offset, xs, ys, i, n);
+	}
+
+	CPU_TARGET("avx2,fma") void avx2Float(const float* c, size_t terms, float scale, float offset, const float* xs, float* ys, size_t n)
+	{
+		constexpr size_t W = 8;
+		const __m256 s = _mm256_set1_ps(scale);
+		const __m256 o = _mm256_set1_ps(offset);
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m256 u[Unroll], u2[Unroll], b1[Unroll], b2[Unroll];
+			for (size_t v = 0; v < Unroll; ++v) {
+				u[v] = _mm256_fmadd_ps(_mm256_loadu_ps(xs + i + v * W), s, o);
+				u2[v] = _mm256_add_ps(u[v], u[v]);
+				b1[v] = _mm256_setzero_ps();
+				b2[v] = _mm256_setzero_ps();
+			}
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const __m256 ck = _mm256_set1_ps(c[k]);
+				for (size_t v = 0; v < Unroll; ++v) {
+					const __m256 b = _mm256_fmadd_ps(u2[v], b1[v], _mm256_sub_ps(ck, b2[v]));
+					b2[v] = b1[v];
+					b1[v] = b;
+				}
+			}
+			const __m256 c0 = _mm256_set1_ps(c[0]);
+			for (size_t v = 0; v < Unroll; ++v) {
+				_mm256_storeu_ps(ys + i + v * W, _mm256_fmadd_ps(u[v], b1[v], _mm256_sub_ps(c0, b2[v])));
+			}
+		}
+		clenshawScalar(c, terms, scale, offset, xs, ys, i, n);
+	}
+
+	// The tail runs through one masked vector instead of a scalar loop.
+	CPU_TARGET("avx512f") void avx512Double(const double* c, size_t terms, double scale, double offset, const double* xs, double* ys, size_t n)
+	{
+		constexpr size_t W = 8;
+		const __m512d s = _mm512_set1_pd(scale);
+		const __m512d o = _mm512_set1_pd(offset);
+		const __m512d c0 = _mm512_set1_pd(c[0]);
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m512d u[Unroll], u2[Unroll], b1[Unroll], b2[Unroll];
+			for (size_t v = 0; v < Unroll; ++v) {
+				u[v] = _mm512_fmadd_pd(_mm512_loadu_pd(xs + i + v * W), s, o);
+				u2[v] = _mm512_add_pd(u[v], u[v]);
+				b1[v] = _mm512_setzero_pd();
+				b2[v] = _mm512_setzero_pd();
+			}
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const __m512d ck = _mm512_set1_pd(c[k]);
+				for (size_t v = 0; v < Unroll; ++v) {
+					const __m512d b = _mm512_fmadd_pd(u2[v], b1[v], _mm512_sub_pd(ck, b2[v]));
+					b2[v] = b1[v];
+					b1[v] = b;
+				}
+			}
+			for (size_t v = 0; v < Unroll; ++v) {
+				_mm512_storeu_pd(ys + i + v * W, _mm512_fmadd_pd(u[v], b1[v], _mm512_sub_pd(c0, b2[v])));
+			}
+		}
+		for (; i < n; i += W) {
+			const __mmask8 mask = static_cast<__mmask8>(n - i >= W ? 0xff : (1u << (n - i)) - 1);
+			const __m512d u = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, xs + i), s, o);
+			const __m512d u2 = _mm512_add_pd(u, u);
+			__m512d b1 = _mm512_setzero_pd();
+			__m512d b2 = _mm512_setzero_pd();
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const __m512d b = _mm512_fmadd_pd(u2, b1, _mm512_sub_pd(_mm512_set1_pd(c[k]), b2));
+				b2 = b1;
+				b1 = b;
+			}
+			_mm512_mask_storeu_pd(ys + i, mask, _mm512_fmadd_pd(u, b1, _mm512_sub_pd(c0, b2)));
+		}
+	}
+
+	CPU_TARGET("avx512f") void avx512Float(const float* c, size_t terms, float scale, float offset, const float* xs, float* ys, size_t n)
+	{
+		constexpr size_t W = 16;
+		const __m512 s = _mm512_set1_ps(scale);
+		const __m512 o = _mm512_set1_ps(offset);
+		const __m512 c0 = _mm512_set1_ps(c[0]);
+		size_t i = 0;
+		for (; i + Unroll * W <= n; i += Unroll * W) {
+			__m512 u[Unroll], u2[Unroll], b1[Unroll], b2[Unroll];
+			for (size_t v = 0; v < Unroll; ++v) {
+				u[v] = _mm512_fmadd_ps(_mm512_loadu_ps(xs + i + v * W), s, o);
+				u2[v] = _mm512_add_ps(u[v], u[v]);
+				b1[v] = _mm512_setzero_ps();
+				b2[v] = _mm512_setzero_ps();
+			}
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const __m512 ck = _mm512_set1_ps(c[k]);
+				for (size_t v = 0; v < Unroll; ++v) {
+					const __m512 b = _mm512_fmadd_ps(u2[v], b1[v], _mm512_sub_ps(ck, b2[v]));
+					b2[v] = b1[v];
+					b1[v] = b;
+				}
+			}
+			for (size_t v = 0; v < Unroll; ++v) {
+				_mm512_storeu_ps(ys + i + v * W, _mm512_fmadd_ps(u[v], b1[v], _mm512_sub_ps(c0, b2[v])));
+			}
+		}
+		for (; i < n; i += W) {
+			const __mmask16 mask = static_cast<__mmask16>(n - i >= W ? 0xffff : (1u << (n - i)) - 1);
+			const __m512 u = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, xs + i), s, o);
+			const __m512 u2 = _mm512_add_ps(u, u);
+			__m512 b1 = _mm512_setzero_ps();
+			__m512 b2 = _mm512_setzero_ps();
+			for (size_t k = terms - 1; k >= 1; --k) {
+				const __m512 b = _mm512_fmadd_ps(u2, b1, _mm512_sub_ps(_mm512_set1_ps(c[k]), b2));
+				b2 = b1;
+				b1 = b;
+			}
+			_mm512_mask_storeu_ps(ys + i, mask, _mm512_fmadd_ps(u, b1, _mm512_sub_ps(c0, b2)));
+		}
+	}
+#endif
+
+	template<typename T>
+	using Kernel = void (*)(const T*, size_t, T, T, const T*, T*, size_t);
+
+	template<typename T>
+	Kernel<T> pickKernel(Kernel<T> avx512, Kernel<T> avx2, Kernel<T> scalar)
+	{
+#if CPU_X86
+		const CpuFeatures& cpu = CpuFeatures::get();
+		if (cpu.avx512f) return avx512;
+		if (cpu.avx2 && cpu.fma) return avx2;
+#endif
+		return scalar;
+	}
+
+	// Maps [lo, hi] onto u in [-1, 1] as u = x * scale + offset.
+	template<typename T>
+	void run(Kernel<T> kernel, std::span<const T> coeffs, T lo, T hi, std::span<const T> xs, std::span<T> ys)
+	{
+		const size_t n = std::min(xs.size(), ys.size());
+		if (coeffs.empty()) {
+			std::fill_n(ys.begin(), n, T(0));
+			return;
+		}
+		const T scale = T(2) / (hi - lo);
+		const T offset = -(lo + hi) / (hi - lo);
+		kernel(coeffs.data(), coeffs.size(), scale, offset, xs.data(), ys.data(), n);
+	}
+
+}
+
+void evalChebyshev(std::span<const double> coeffs, double lo, double hi, std::span<const double> xs, std::span<double> ys)
+{
+#if CPU_X86
+	static const Kernel<double> kernel = pickKernel<double>(&avx512Double, &avx2Double, &scalarDouble);
+#else
+	static const Kernel<double> kernel = &scalarDouble;
+#endif
+	run(kernel, coeffs, lo, hi, xs, ys);
+}
+
+void evalChebyshev(std::span<const float> coeffs, float lo, float hi, std::span<const float> xs, std::span<float> ys)
+{
+#if CPU_X86
+	static const Kernel<float> kernel = pickKernel<float>(&avx512Float, &avx2Float, &scalarFloat);
+#else
+	static const Kernel<float> kernel = &scalarFloat;
+#endif
+	run(kernel, coeffs, lo, hi, xs, ys);
+}
+
+void evalChebyshevScalar(std::span<const double> coeffs, double lo, double hi, std::span<const double> xs, std::span<double> ys)
+{
+	run<double>(&scalarDouble, coeffs, lo, hi, xs, ys);
+}
+
+void evalChebyshevScalar(std::span<const float> coeffs, float lo, float hi, std::span<const float> xs, std::span<float> ys)
+{
+	run<float>(&scalarFloat, coeffs, lo, hi, xs, ys);
+}
@@ -0,0 +1,222 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <vector>
+#include "ChebyshevEval.h"
+#include "PolyFit.h"
+
+// Least-squares fit in the Chebyshev basis on [lo, hi]. x is mapped to
+// u = (2x - (lo + hi)) / (hi - lo) in [-1, 1] and the fit is
+// p(x) = c_0 T_0(u) + ... + c_Degree T_Degree(u). The T_k are bounded by 1
+// and close to orthogonal on [-1, 1], so the least-squares system stays well
+// conditioned where the monomial one of PolyFit does not (high degree, large
+// |x|), which makes fitting and evaluating in float practical.
+// Coefficients are ordered lowest order first, the usual order for Chebyshev
+// series and the one Clenshaw's recurrence consumes.
+template<int Degree, typename Scalar = double>
+class ChebyshevFit {
+public:
+	static_assert(Degree >= 0, "ChebyshevFit needs a non-negative degree");
+
+	static constexpr int Terms = Degree + 1;
+
+	// Number of rows folded into R at a time, as in PolyFit.
+	static constexpr int BlockRows = PolyFit<Degree, Scalar>::BlockRows;
+
+	using Coeffs = Eigen::Matrix<Scalar, Terms, 1>;
+
+	ChebyshevFit() = default;
+	ChebyshevFit(const Coeffs& coeffs, Scalar lo, Scalar hi) : coeffs(coeffs), lo(lo), hi(hi) {}
+
+	const Coeffs& coefficients() const { return coeffs; }
+	Scalar lower() const { return lo; }
+	Scalar upper() const { return hi; }
+
+	// The n Chebyshev nodes of the first kind on [lo, hi],
+	// x_m = mid + half * cos(pi (m + 1/2) / n), from hi down to lo.
+	static std::vector<Scalar> nodes(Scalar lo, Scalar hi, size_t n)
+	{
+		std::vector<Scalar> xs(n);
+		const double mid = 0.5 * (double(lo) + double(hi));
+		const double half = 0.5 * (double(hi) - double(lo));
+		for (size_t m = 0; m < n; ++m) {
+			xs[m] = static_cast<Scalar>(mid + half * std::cos(std::numbers::pi * (m + 0.5) / n));
+		}
+		return xs;
+	}
+
+	// Fit to ys[m] sampled at nodes(lo, hi, ys.size()). At the nodes the T_k
+	// are exactly orthogonal, so the least-squares coefficients are plain sums,
+	// c_k = (2 / n) sum_m ys[m] T_k(u_m) (half that for c_0), in O(n * Degree)
+	// without any factorisation. Fewer than Terms samples, or an empty
+	// interval, go through fit(), which widens the interval as it does for
+	// points that all share one x.
+	static ChebyshevFit fitAtNodes(Scalar lo, Scalar hi, std::span<const Scalar> ys)
+	{
+		const size_t n = ys.size();
+		if (n < static_cast<size_t>(Terms) || !(hi > lo)) {
+			const std::vector<Scalar> xs = nodes(lo, hi, n);
+			return fit(static_cast<Eigen::Index>(n), lo, hi, [&](Eigen::Index i) { return std::pair<Scalar, Scalar>(xs[i], ys[i]); });
+		}
+
+		Coeffs c = Coeffs::Zero();
+		for (size_t m = 0; m < n; ++m) {
+			const Scalar u = static_cast<Scalar>(std::cos(std::numbers::pi * (m + 0.5) / n));
+			Scalar previous = 1;
+			Scalar current = u;
+			c(0) += ys[m];
+			for (int k = 1; k < Terms; ++k) {
+				c(k) += ys[m] * current;
+				const Scalar next = 2 * u * current - previous;
+				previous = current;
+				current = next;
+			}
+		}
+		c *= Scalar(2) / static_cast<Scalar>(n);
+		c(0) *= Scalar(0.5);
+		return ChebyshevFit(c, lo, hi);
+	}
+
+	// Least squares for arbitrary points by QR of the Chebyshev design
+	// matrix, folded in blocks of BlockRows exactly like PolyFit::fit, so it
+	// never allocates. pointAt(i) must return something with .first (x) and
+	// .second (y); x outside [lo, hi] is allowed but extrapolates.
+	template<typename PointAt>
+	static ChebyshevFit fit(Eigen::Index n, Scalar lo, Scalar hi, PointAt pointAt)
+	{
+		if (!(hi > lo)) {
+			lo -= 1;
+			hi += 1;
+		}
+		const Scalar scale = Scalar(2) / (hi - lo);
+		const Scalar offset = -(lo + hi) / (hi - lo);
+
+		AugmentedR R = AugmentedR::Zero();
+		BlockMatrix block;
+		for (Eigen::Index start = 0; start < n; start += BlockRows) {
+			const Eigen::Index count = std::min<Eigen::Index>(BlockRows, n - start);
+			block.resize(Terms + 1 + count, Terms + 1);
+			block.topRows(Terms + 1) = R;
+			for (Eigen::Index i = 0; i < count; ++i) {
+				const auto point = pointAt(start + i);
+				const Eigen::Index row = Terms + 1 + i;
+				fillRow(block, row, static_cast<Scalar>(point.first) * scale + offset);
+				block(row, Terms) = static_cast<Scalar>(point.second);
+			}
+
+			PolyFit<Degree, Scalar>::triangularize(block);
+			R = block.template topRows<Terms + 1>().template triangularView<Eigen::Upper>();
+		}
+
+		const SquareMatrix upper = R.template topLeftCorner<Terms, Terms>();
+		return ChebyshevFit(upper.colPivHouseholderQr().solve(R.col(Terms).template head<Terms>()), lo, hi);
+	}
+
+	// Fit over the x range of the points.
+	static ChebyshevFit fit(const PointSet& points)
+	{
+		Scalar lo = 0;
+		Scalar hi = 0;
+		if (!points.empty()) {
+			const auto [low, high] = std::minmax_element(points.begin(), points.end());
+			lo = static_cast<Scalar>(low->first);
+			hi = static_cast<Scalar>(high->first);
+		}
+		return fit(static_cast<Eigen::Index>(points.size()), lo, hi, [&](Eigen::Index i) { return points[i]; });
+	}
+
+	// Clenshaw's recurrence for one x, rounding like evalChebyshev.
+	Scalar operator()(Scalar x) const
+	{
+		const Scalar u = std::fma(x, Scalar(2) / (hi - lo), -(lo + hi) / (hi - lo));
+		const Scalar u2 = u + u;
+		Scalar b1 = 0;
+		Scalar b2 = 0;
+		for (int k = Degree; k >= 1; --k) {
+			const Scalar b = std::fma(u2, b1, coeffs(k) - b2);
+			b2 = b1;
+			b1 = b;
+		}
+		return std::fma(u, b1, coeffs(0) - b2);
+	}
+
+	// ys[i] = p(xs[i]) through the SIMD Clenshaw kernels.
+	void evaluate(std::span<const Scalar> xs, std::span<Scalar> ys) const
+	{
+		evalChebyshev(std::span<const Scalar>(coeffs.data(), Terms), lo, hi, xs, ys);
+	}
+
+	// The same polynomial in the monomial basis of x, highest power first, for
+	// code that takes PolyFit coefficients. This gives up the conditioning of
+	// the Chebyshev basis, so prefer evaluate() where precision matters.
+	typename PolyFit<Degree, Scalar>::Coeffs toMonomial() const
+	{
+		// Power-basis coefficients of sum c_k T_k(u), lowest power first, using
+		// T_(k+1) = 2u T_k - T_(k-1) on the coefficient arrays.
+		Scalar inU[Terms] = {};
+		Scalar previous[Terms] = {};
+		Scalar current[Terms] = {};
+		previous[0] = 1;
+		inU[0] = coeffs(0);
+		if constexpr (Degree >= 1) {
+			current[1] = 1;
+			inU[1] += coeffs(1);
+		}
+		for (int k = 2; k < Terms; ++k) {
+			Scalar next[Terms] = {};
+			for (int t = 0; t < Terms; ++t) {
+				next[t] = (t > 0 ? 2 * current[t - 1] : Scalar(0)) - previous[t];
+			}
+			for (int t = 0; t < Terms; ++t) {
+				previous[t] = current[t];
+				current[t] = next[t];
+				inU[t] += coeffs(k) * current[t];
+			}
+		}
+
+		// Substitute u = a x + b by Horner on polynomials, lowest power first.
+		const Scalar a = Scalar(2) / (hi - lo);
+		const Scalar b = -(lo + hi) / (hi - lo);
+		Scalar inX[Terms] = {};
+		for (int j = Degree; j >= 0; --j) {
+			for (int t = Degree; t >= 1; --t) {
+				inX[t] = a * inX[t - 1] + b * inX[t];
+			}
+			inX[0] = b * inX[0] + inU[j];
+		}
+
+		typename PolyFit<Degree, Scalar>::Coeffs p;
+		for (int t = 0; t < Terms; ++t) {
+			p(Degree - t) = inX[t];
+		}
+		return p;
+	}
+
+private:
+	using SquareMatrix = Eigen::Matrix<Scalar, Terms, Terms>;
+	using AugmentedR = Eigen::Matrix<Scalar, Terms + 1, Terms + 1>;
+	using BlockMatrix = typename PolyFit<Degree, Scalar>::BlockMatrix;
+
+	// Writes T_0(u), ..., T_Degree(u) into row i of A.
+	template<typename Derived>
+	static void fillRow(Eigen::MatrixBase<Derived>& A, Eigen::Index i, Scalar u)
+	{
+		Scalar previous = 1;
+		Scalar current = u;
+		A(i, 0) = previous;
+		for (int k = 1; k < Terms; ++k) {
+			A(i, k) = current;
+			const Scalar next = 2 * u * current - previous;
+			previous = current;
+			current = next;
+		}
+	}
+
+	Coeffs coeffs = Coeffs::Zero();
+	Scalar lo = -1;
+	Scalar hi = 1;
+};
@@ -0,0 +1,51 @@
+#include "CpuFeatures.h"
+
+#if CPU_X86 && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+	CpuFeatures detect()
+	{
+		CpuFeatures features;
+
+#if CPU_X86 && defined(_MSC_VER) && !defined(__clang__)
+		int regs[4];
+		__cpuid(regs, 0);
+		const int maxLeaf = regs[0];
+
+		__cpuid(regs, 1);
+		features.sse2 = (regs[3] & (1 << 26)) != 0;
+		const bool osxsave = (regs[2] & (1 << 27)) != 0;
+		const bool fma = (regs[2] & (1 << 12)) != 0;
+
+		// The OS has to save the wider registers on context switch before they can be used.
+		unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+		const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+		const bool zmmEnabled = (xcr0 & 0xe6) == 0xe6;
+
+		if (maxLeaf >= 7) {
+			__cpuidex(regs, 7, 0);
+			features.avx2 = ymmEnabled && (regs[1] & (1 << 5)) != 0;
+			features.avx512f = zmmEnabled && (regs[1] & (1 << 16)) != 0;
+		}
+		features.fma = ymmEnabled && fma;
+#elif CPU_X86
+		__builtin_cpu_init();
+		features.sse2 = __builtin_cpu_supports("sse2");
+		features.avx2 = __builtin_cpu_supports("avx2");
+		features.fma = __builtin_cpu_supports("fma");
+		features.avx512f = __builtin_cpu_supports("avx512f");
+#endif
+
+		return features;
+	}
+
+}
+
+const CpuFeatures& CpuFeatures::get()
+{
+	static const CpuFeatures features = detect();
+	return features;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#include <immintrin.h>
+#else
+#define CPU_X86 0
+#endif
+
+// Marks a function as compiled for an instruction set beyond the build's
+// baseline. MSVC allows intrinsics anywhere, GCC and Clang need the attribute.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CPU_TARGET(isa)
+#else
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// Instruction sets the running CPU and OS both support. Kernels with several
+// implementations check this once and keep a function pointer to the widest one.
+struct CpuFeatures
+{
+	bool sse2 = false;
+	bool avx2 = false;
+	bool fma = false;
+	bool avx512f = false;
+
+	static const CpuFeatures& get();
+};
@@ -0,0 +1,317 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "PolyFit.h"
+
+// Piecewise cubic through (or, smoothed, near) a set of knots, for data that
+// no single low-degree polynomial represents. The spline is stored as knot
+// positions, values and second derivatives M_i; on [x_i, x_(i+1)], h = x_(i+1) - x_i,
+//   S(x) = (M_i (x_(i+1) - x)^3 + M_(i+1) (x - x_i)^3) / (6h)
+//        + (y_i / h - M_i h / 6) (x_(i+1) - x) + (y_(i+1) / h - M_(i+1) h / 6) (x - x_i).
+// Outside the knots each end segment's cubic is extended.
+
+// Natural: S'' = 0 at both ends. Clamped: S' takes given slopes at the ends.
+enum class SplineBoundary {
+	Natural,
+	Clamped
+};
+
+// Solves the tridiagonal system with sub-diagonal lower[i] (row i + 1),
+// diagonal diag[i] and super-diagonal upper[i] (row i), overwriting rhs with
+// the solution and diag with scratch. Thomas' algorithm: one elimination
+// sweep and one back substitution, O(n), no pivoting, so the matrix must be
+// diagonally dominant, as every spline system here is.
+inline void solveTridiagonal(std::span<const double> lower, std::span<double> diag, std::span<const double> upper, std::span<double> rhs)
+{
+	const size_t n = diag.size();
+	for (size_t i = 1; i < n; ++i) {
+		const double factor = lower[i - 1] / diag[i - 1];
+		diag[i] -= factor * upper[i - 1];
+		rhs[i] -= factor * rhs[i - 1];
+	}
+	if (n == 0) {
+		return;
+	}
+	rhs[n - 1] /= diag[n - 1];
+	for (size_t i = n - 1; i-- > 0;) {
+		rhs[i] = (rhs[i] - upper[i] * rhs[i + 1]) / diag[i];
+	}
+}
+
+// Solves the symmetric positive definite pentadiagonal system with diagonal
+// diag[i], first sub-diagonal sub1[i] (entry (i + 1, i)) and second
+// sub-diagonal sub2[i] (entry (i + 2, i)) by a banded LDL^T factorisation,
+// overwriting rhs with the solution and the bands with the factor. O(n); the
+// band has no room for fill-in, so nothing beyond the inputs is stored.
+// Returns false if a pivot is not positive, i.e. the matrix is not SPD.
+inline bool solvePentadiagonal(std::span<double> diag, std::span<double> sub1, std::span<double> sub2, std::span<double> rhs)
+{
+	const size_t n = diag.size();
+	for (size_t i = 0; i < n; ++i) {
+		if (i >= 1) {
+			diag[i] -= sub1[i - 1] * sub1[i - 1] * diag[i - 1];
+		}
+		if (i >= 2) {
+			diag[i] -= sub2[i - 2] * sub2[i - 2] * diag[i - 2];
+		}
+		if (!(diag[i] > 0)) {
+			return false;
+		}
+		if (i + 1 < n) {
+			if (i >= 1) {
+				sub1[i] -= sub2[i - 1] * diag[i - 1] * sub1[i - 1];
+			}
+			sub1[i] /= diag[i];
+		}
+		if (i + 2 < n) {
+			sub2[i] /= diag[i];
+		}
+	}
+
+	for (size_t i = 1; i < n; ++i) {
+		rhs[i] -= sub1[i - 1] * rhs[i - 1];
+		if (i >= 2) {
+			rhs[i] -= sub2[i - 2] * rhs[i - 2];
+		}
+	}
+	for (size_t i = n; i-- > 0;) {
+		rhs[i] /= diag[i];
+		if (i + 1 < n) {
+			rhs[i] -= sub1[i] * rhs[i + 1];
+		}
+		if (i + 2 < n) {
+			rhs[i] -= sub2[i] * rhs[i + 2];
+		}
+	}
+	return true;
+}
+
+class CubicSpline {
+public:
+	// Relative spacing deviation up to which the knots count as a uniform grid.
+	static constexpr double UniformTolerance = 1e-9;
+
+	CubicSpline() = default;
+
+	// Interpolating spline through knots with strictly increasing xs.
+	// startSlope and endSlope are only used for SplineBoundary::Clamped.
+	static CubicSpline interpolate(std::span<const double> xs, std::span<const double> ys, SplineBoundary boundary = SplineBoundary::Natural, double startSlope = 0, double endSlope = 0)
+	{
+		CubicSpline spline(xs, ys);
+		const size_t n = spline.xs.size();
+		if (n < 2) {
+			return spline;
+		}
+
+		// Row i: h_(i-1) M_(i-1) + 2 (h_(i-1) + h_i) M_i + h_i M_(i+1)
+		//        = 6 (slope_i - slope_(i-1)), slope_i = (y_(i+1) - y_i) / h_i.
+		std::vector<double> lower(n - 1), diag(n), upper(n - 1);
+		std::vector<double>& rhs = spline.second;
+		rhs.assign(n, 0.0);
+		for (size_t i = 1; i + 1 < n; ++i) {
+			const double left = spline.xs[i] - spline.xs[i - 1];
+			const double right = spline.xs[i + 1] - spline.xs[i];
+			lower[i - 1] = left;
+			diag[i] = 2 * (left + right);
+			upper[i] = right;
+			rhs[i] = 6 * ((spline.ys[i + 1] - spline.ys[i]) / right - (spline.ys[i] - spline.ys[i - 1]) / left);
+		}
+
+		const double first = spline.xs[1] - spline.xs[0];
+		const double last = spline.xs[n - 1] - spline.xs[n - 2];
+		if (boundary == SplineBoundary::Clamped) {
+			diag[0] = 2 * first;
+			upper[0] = first;
+			rhs[0] = 6 * ((spline.ys[1] - spline.ys[0]) / first - startSlope);
+			lower[n - 2] = last;
+			diag[n - 1] = 2 * last;
+			rhs[n - 1] = 6 * (endSlope - (spline.ys[n - 1] - spline.ys[n - 2]) / last);
+		} else {
+			diag[0] = 1;
+			upper[0] = 0;
+			lower[n - 2] = 0;
+			diag[n - 1] = 1;
+		}
+
+		solveTridiagonal(lower, diag, upper, rhs);
+		return spline;
+	}
+
+	// Same for a point set, which is sorted by x first; points sharing an x
+	// are merged into one knot at their mean y.
+	static CubicSpline interpolate(const PointSet& points, SplineBoundary boundary = SplineBoundary::Natural, double startSlope = 0, double endSlope = 0)
+	{
+		std::vector<double> xs, ys, counts;
+		knotsOf(points, xs, ys, counts);
+		return interpolate(xs, ys, boundary, startSlope, endSlope);
+	}
+
+	// Smoothing spline (Reinsch): the natural cubic spline g minimising
+	//   sum_i w_i (y_i - g(x_i))^2 + lambda * integral g''(x)^2 dx
+	// over strictly increasing xs, with positive weights w (all 1 when weights
+	// is shorter than xs). lambda = 0 interpolates, large lambda tends to the
+	// weighted least-squares line. With Q the n x (n-2) second-difference
+	// matrix, R the (n-2) x (n-2) tridiagonal Gram matrix of the hat functions
+	// and W = diag(w), the interior second derivatives solve
+	// (R + lambda Q^T W^-1 Q) M = Q^T y, and g = y - lambda W^-1 Q M at the
+	// knots. The system is symmetric positive definite and pentadiagonal, so
+	// solvePentadiagonal factors it in O(n).
+	static CubicSpline smooth(std::span<const double> xs, std::span<const double> ys, double lambda, std::span<const double> weights = {})
+	{
+		CubicSpline spline(xs, ys);
+		const size_t n = spline.xs.size();
+		if (n < 3) {
+			return spline;
+		}
+		if (!(lambda > 0)) {
+			return interpolate(xs, ys);
+		}
+
+		const size_t m = n - 2;
+		const auto h = [&](size_t i) { return spline.xs[i + 1] - spline.xs[i]; };
+		const auto inverseWeight = [&](size_t i) { return weights.size() >= n ? 1 / weights[i] : 1.0; };
+
+		// Column j of Q (interior knot j + 1) has entries at rows j, j + 1, j + 2.
+		const auto q = [&](size_t j, int offset) {
+			if (offset == 0) return 1 / h(j);
+			if (offset == 1) return -1 / h(j) - 1 / h(j + 1);
+			return 1 / h(j + 1);
+		};
+
+		std::vector<double> diag(m), sub1(m), sub2(m);
+		std::vector<double>& M = spline.second;
+		M.assign(n, 0.0);
+		for (size_t j = 0; j < m; ++j) {
+			const double q0 = q(j, 0);
+			const double q1 = q(j, 1);
+			const double q2 = q(j, 2);
+			const double v0 = inverseWeight(j);
+			const double v1 = inverseWeight(j + 1);
+			const double v2 = inverseWeight(j + 2);
+			diag[j] = (h(j) + h(j + 1)) / 3 + lambda * (q0 * q0 * v0 + q1 * q1 * v1 + q2 * q2 * v2);
+			if (j + 1 < m) {
+				sub1[j] = h(j + 1) / 6 + lambda * (q1 * q(j + 1, 0) * v1 + q2 * q(j + 1, 1) * v2);
+			}
+			if (j + 2 < m) {
+				sub2[j] = lambda * q2 * q(j + 2, 0) * v2;
+			}
+			M[j + 1] = q0 * spline.ys[j] + q1 * spline.ys[j + 1] + q2 * spline.ys[j + 2];
+		}
+
+		const std::span<double> interior(M.data() + 1, m);
+		if (!solvePentadiagonal(diag, sub1, sub2, interior)) {
+			return interpolate(xs, ys);
+		}
+
+		// Fitted values: g_i = y_i - lambda (Q M)_i / w_i.
+		for (size_t j = 0; j < m; ++j) {
+			for (size_t r = 0; r < 3; ++r) {
+				spline.ys[j + r] -= lambda * q(j, static_cast<int>(r)) * interior[j] * inverseWeight(j + r);
+			}
+		}
+		return spline;
+	}
+
+	// Same for a point set. Points sharing an x are merged into one knot at
+	// their mean y, weighted by how many there are, which leaves the objective
+	// over the original points unchanged up to a constant.
+	static CubicSpline smooth(const PointSet& points, double lambda)
+	{
+		std::vector<double> xs, ys, counts;
+		knotsOf(points, xs, ys, counts);
+		return smooth(xs, ys, lambda, counts);
+	}
+
+	size_t size() const { return xs.size(); }
+	std::span<const double> knots() const { return xs; }
+	std::span<const double> values() const { return ys; }
+	std::span<const double> secondDerivatives() const { return second; }
+
+	double operator()(double x) const
+	{
+		if (xs.empty()) {
+			return 0;
+		}
+		if (xs.size() == 1) {
+			return ys[0];
+		}
+		const size_t i = segment(x);
+		const double h = xs[i + 1] - xs[i];
+		const double right = xs[i + 1] - x;
+		const double left = x - xs[i];
+		return (second[i] * right * right * right + second[i + 1] * left * left * left) / (6 * h)
+			+ (ys[i] / h - second[i] * h / 6) * right
+			+ (ys[i + 1] / h - second[i + 1] * h / 6) * left;
+	}
+
+	// values[i] = S(at[i]) for i < min(at.size(), values.size()).
+	void evaluate(std::span<const double> at, std::span<double> values) const
+	{
+		const size_t n = std::min(at.size(), values.size());
+		for (size_t i = 0; i < n; ++i) {
+			values[i] = (*this)(at[i]);
+		}
+	}
+
+private:
+	CubicSpline(std::span<const double> knotXs, std::span<const double> knotYs)
+		: xs(knotXs.begin(), knotXs.begin() + std::min(knotXs.size(), knotYs.size())),
+		  ys(knotYs.begin(), knotYs.begin() + xs.size()),
+		  second(xs.size(), 0.0)
+	{
+		const size_t n = xs.size();
+		if (n < 2) {
+			return;
+		}
+		const double step = (xs[n - 1] - xs[0]) / static_cast<double>(n - 1);
+		uniform = step > 0;
+		for (size_t i = 1; uniform && i + 1 < n; ++i) {
+			uniform = std::abs(xs[i] - (xs[0] + static_cast<double>(i) * step)) <= UniformTolerance * step;
+		}
+		inverseStep = uniform ? 1 / step : 0;
+	}
+
+	// Index of the segment [x_i, x_(i+1)] that holds x, with the end segments
+	// extended outward. On a uniform grid the index comes straight from x, with
+	// one correction step against rounding; otherwise by binary search.
+	size_t segment(double x) const
+	{
+		const size_t last = xs.size() - 2;
+		if (uniform) {
+			const double position = (x - xs[0]) * inverseStep;
+			size_t i = position <= 0 ? 0 : std::min(static_cast<size_t>(position), last);
+			if (i > 0 && x < xs[i]) --i;
+			else if (i < last && x > xs[i + 1]) ++i;
+			return i;
+		}
+		const auto it = std::upper_bound(xs.begin() + 1, xs.end() - 1, x);
+		return static_cast<size_t>(it - xs.begin()) - 1;
+	}
+
+	// Sorted distinct xs, the mean y at each and how many points it merges.
+	static void knotsOf(const PointSet& points, std::vector<double>& xs, std::vector<double>& ys, std::vector<double>& counts)
+	{
+		PointSet sorted = points;
+		std::sort(sorted.begin(), sorted.end());
+		for (size_t i = 0; i < sorted.size();) {
+			size_t j = i;
+			double sum = 0;
+			for (; j < sorted.size() && sorted[j].first == sorted[i].first; ++j) {
+				sum += sorted[j].second;
+			}
+			xs.push_back(sorted[i].first);
+			ys.push_back(sum / static_cast<double>(j - i));
+			counts.push_back(static_cast<double>(j - i));
+			i = j;
+		}
+	}
+
+	std::vector<double> xs;
+	std::vector<double> ys;
+	std::vector<double> second;
+	bool uniform = false;
+	double inverseStep = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "EvalPoly.h"
+#include "ForwardDifference.h"
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Samples a polynomial at x_i = start + i * step. Computing x from the index
+// rather than accumulating x += step keeps every sample exact to one rounding
+// (so an end point like 1.0 in 0.1 steps is not lost to drift) and lets any
+// range of i be produced independently. The range is cut into chunks that fit
+// in cache; each pool thread evaluates whole chunks with evalPoly and writes
+// them straight into its slice of an output allocated once up front.
+
+// How close (in steps) the last sample may fall short of end and still count
+// as reaching it.
+constexpr double SampleCountTolerance = 1e-9;
+
+// Samples per chunk: the x and y scratch of one chunk stay in L1/L2.
+constexpr size_t SampleChunk = 2048;
+
+// Horner evaluates every sample to within a rounding or two. ForwardDifference
+// (see ForwardDifference.h) needs only Degree additions per sample and is the
+// faster choice for dense plotting, at a slightly larger but bounded error.
+enum class SamplingMode {
+	Horner,
+	ForwardDifference
+};
+
+// ys[j] = p(start + (first + j) * step) for every j in ys.
+inline void sampleChunk(std::span<const double> coeffs, double start, double step, size_t first, std::span<const double> xs, std::span<double> ys, SamplingMode mode)
+{
+	if (mode == SamplingMode::ForwardDifference) {
+		forwardDifferenceRange(coeffs, start, step, first, ys);
+	} else {
+		evalPoly(coeffs, xs, ys);
+	}
+}
+
+// Number of samples start, start + step, ... that do not pass end.
+inline size_t sampleCount(double start, double end, double step)
+{
+	if (!(step > 0) || !(end >= start)) {
+		return 0;
+	}
+	return static_cast<size_t>(std::floor((end - start) / step + SampleCountTolerance)) + 1;
+}
+
+inline double sampleX(double start, double step, size_t i)
+{
+	return start + static_cast<double>(i) * step;
+}
+
+// xs[i] = start + i * step and ys[i] = p(xs[i]) for i < min(xs.size(), ys.size()).
+inline void sampleInto(std::span<const double> coeffs, double start, double step, std::span<double> xs, std::span<double> ys, ThreadPool& pool = ThreadPool::shared(), SamplingMode mode = SamplingMode::Horner)
+{
+	const size_t count = std::min(xs.size(), ys.size());
+	pool.parallelFor(count, SampleChunk, [&](unsigned, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			xs[i] = sampleX(start, step, i);
+		}
+		sampleChunk(coeffs, start, step, begin, xs.subspan(begin, end - begin), ys.subspan(begin, end - begin), mode);
+	});
+}
+
+// Same samples as (x, y) pairs over [start, end].
+inline PointSet samplePolynomial(std::span<const double> coeffs, double start, double end, double step, ThreadPool& pool = ThreadPool::shared(), SamplingMode mode = SamplingMode::Horner)
+{
+	PointSet points(sampleCount(start, end, step));
+	pool.parallelFor(points.size(), SampleChunk, [&](unsigned, size_t begin, size_t last) {
+		double xs[SampleChunk];
+		double ys[SampleChunk];
+		for (size_t chunk = begin; chunk < last; chunk += SampleChunk) {
+			const size_t size = std::min(SampleChunk, last - chunk);
+			for (size_t i = 0; i < size; ++i) {
+				xs[i] = sampleX(start, step, chunk + i);
+			}
+			sampleChunk(coeffs, start, step, chunk, std::span<const double>(xs, size), std::span<double>(ys, size), mode);
+			for (size_t i = 0; i < size; ++i) {
+				points[chunk + i] = {xs[i], ys[i]};
+			}
+		}
+	});
+	return points;
+}
+
+// Interleaved float vertices in vertex-buffer layout: x, y for stride 2, and
+// x, y, 0 for stride 3. Writes vertices.size() / stride samples, so the caller
+// sizes the span (or a mapped buffer) once with sampleCount and nothing is
+// copied or reallocated on the way.
+inline void sampleVertices(std::span<const double> coeffs, double start, double step, std::span<float> vertices, size_t stride, ThreadPool& pool = ThreadPool::shared(), SamplingMode mode = SamplingMode::Horner)
+{
+	stride = std::max<size_t>(stride, 2);
+	pool.parallelFor(vertices.size() / stride, SampleChunk, [&](unsigned, size_t begin, size_t last) {
+		double xs[SampleChunk];
+		double ys[SampleChunk];
+		for (size_t chunk = begin; chunk < last; chunk += SampleChunk) {
+			const size_t size = std::min(SampleChunk, last - chunk);
+			for (size_t i = 0; i < size; ++i) {
+				xs[i] = sampleX(start, step, chunk + i);
+			}
+			sampleChunk(coeffs, start, step, chunk, std::span<const double>(xs, size), std::span<double>(ys, size), mode);
+
+			float* out = vertices.data() + chunk * stride;
+			for (size_t i = 0; i < size; ++i, out += stride) {
+				out[0] = static_cast<float>(xs[i]);
+				out[1] = static_cast<float>(ys[i]);
+				for (size_t extra = 2; extra < stride; ++extra) out[extra] = 0.0f;
+			}
+		}
+	});
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <span>
+
+// ys[i] = p(xs[i]) for a polynomial of any degree, coefficients highest power
+// first (the (a, b, c) order Main.cpp prints). Evaluation is Horner's rule,
+// y = y * x + c, over as many x per instruction as the CPU allows: AVX-512,
+// AVX2 with FMA or SSE2, picked once at runtime.
+// The FMA kernels round exactly like evalPolyScalar, so their results are
+// bit-identical to it. SSE2 has no fused multiply-add and rounds the product
+// separately, which stays within the usual Horner error bound of the reference.
+// Only min(xs.size(), ys.size()) values are written; empty coeffs give 0.
+void evalPoly(std::span<const double> coeffs, std::span<const double> xs, std::span<double> ys);
+void evalPoly(std::span<const float> coeffs, std::span<const float> xs, std::span<float> ys);
+
+// Portable reference: Horner with std::fma.
+void evalPolyScalar(std::span<const double> coeffs, std::span<const double> xs, std::span<double> ys);
+void evalPolyScalar(std::span<const float> coeffs, std::span<const float> xs, std::span<float> ys);
+
+// The kernels evalPoly picks from. evalPolyWith runs the given one whatever
+// the widest supported is, so each can be compared with evalPolyScalar; it
+// returns false and writes nothing if the CPU or build lacks that kernel.
+enum class PolyKernel {
+	Scalar,
+	Sse2,
+	Avx2,
+	Avx512
+};
+
+bool evalPolyWith(PolyKernel kernel, std::span<const double> coeffs, std::span<const double> xs, std::span<double> ys);
+bool evalPolyWith(PolyKernel kernel, std::span<const float> coeffs, std::span<const float> xs, std::span<float> ys);
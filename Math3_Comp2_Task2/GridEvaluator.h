@@ -0,0 +1,56 @@
+#pragma once
+#include <Eigen/Dense>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Evaluates many polynomials of the same degree on one shared x grid, the
+// evaluation counterpart of SharedGridFit. The grid's n x (Degree+1)
+// Vandermonde matrix V is built once; evaluating k curves is then the single
+// product Y = V * C, with one curve per column of C (as SharedGridFit::solve
+// returns them) and one curve per column of Y. Y is column-major, so each
+// curve's samples are contiguous, ready to upload or export.
+// Row blocks of the product run on separate threads, each one a blocked
+// Eigen GEMM that reuses the block of V for every curve.
+template<int Degree>
+class GridEvaluator {
+public:
+	static constexpr int Terms = Degree + 1;
+
+	using CoeffMatrix = Eigen::Matrix<double, Terms, Eigen::Dynamic>;
+	using Vandermonde = Eigen::Matrix<double, Eigen::Dynamic, Terms>;
+
+	explicit GridEvaluator(const std::vector<double>& xs)
+		: V(static_cast<Eigen::Index>(xs.size()), Terms)
+	{
+		for (Eigen::Index i = 0; i < V.rows(); ++i) {
+			PolyFit<Degree>::fillRow(V, i, xs[i]);
+		}
+	}
+
+	Eigen::Index gridSize() const { return V.rows(); }
+
+	const Vandermonde& vandermonde() const { return V; }
+
+	// Y(i, j) = value of curve j at xs[i]. Y must be gridSize() x C.cols().
+	void evaluateInto(const CoeffMatrix& C, Eigen::Ref<Eigen::MatrixXd> Y, ThreadPool& pool = ThreadPool::shared()) const
+	{
+		pool.parallelFor(static_cast<size_t>(V.rows()), RowBlock, [&](unsigned, size_t begin, size_t end) {
+			const Eigen::Index count = static_cast<Eigen::Index>(end - begin);
+			Y.middleRows(begin, count).noalias() = V.middleRows(begin, count) * C;
+		});
+	}
+
+	Eigen::MatrixXd evaluate(const CoeffMatrix& C, ThreadPool& pool = ThreadPool::shared()) const
+	{
+		Eigen::MatrixXd Y(V.rows(), C.cols());
+		evaluateInto(C, Y, pool);
+		return Y;
+	}
+
+private:
+	// Rows per task: the block of V stays in L1 while it is multiplied by C.
+	static constexpr size_t RowBlock = 512;
+
+	Vandermonde V;
+};
@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include "PolyFit.h"
+
+// The polynomial through exactly Degree + 1 points, kept in barycentric form
+//   p(x) = sum_j (w_j y_j / (x - x_j)) / sum_j (w_j / (x - x_j)),
+//   w_j = 1 / prod_(k != j) (x_j - x_k).
+// Setting all points costs O(Degree^2), evaluating or moving a single point
+// O(Degree): when x_j moves, every other weight changes by one factor. This
+// suits sliding or dragged points, where PolyFit::fit would start over.
+// The second (true) barycentric form above is numerically stable for any node
+// positions and needs no coefficients; coefficients() gives PolyFit's
+// monomial form when a caller needs it.
+template<int Degree>
+class Interpolant {
+public:
+	static constexpr int Terms = Degree + 1;
+
+	using Coeffs = typename PolyFit<Degree>::Coeffs;
+
+	// pointAt(i) must return something with .first (x) and .second (y).
+	// Returns false, leaving the interpolant unchanged, when two x coincide.
+	template<typename PointAt>
+	bool reset(PointAt pointAt)
+	{
+		double nextXs[Terms];
+		double nextWeights[Terms];
+		for (int j = 0; j < Terms; ++j) {
+			nextXs[j] = static_cast<double>(pointAt(j).first);
+		}
+		for (int j = 0; j < Terms; ++j) {
+			double product = 1;
+			for (int k = 0; k < Terms; ++k) {
+				if (k != j) {
+					product *= nextXs[j] - nextXs[k];
+				}
+			}
+			if (product == 0) {
+				return false;
+			}
+			nextWeights[j] = 1 / product;
+		}
+		for (int j = 0; j < Terms; ++j) {
+			xs[j] = nextXs[j];
+			ys[j] = static_cast<double>(pointAt(j).second);
+			weights[j] = nextWeights[j];
+		}
+		return true;
+	}
+
+	// The first Terms points of the set.
+	bool reset(const PointSet& points)
+	{
+		if (points.size() < static_cast<size_t>(Terms)) {
+			return false;
+		}
+		return reset([&](int i) { return points[i]; });
+	}
+
+	// Moves point j to `point` in O(Degree). Returns false, leaving the
+	// interpolant unchanged, when the new x coincides with another point's.
+	bool update(int j, const std::pair<double, double>& point)
+	{
+		const double oldX = xs[j];
+		const double newX = point.first;
+		double product = 1;
+		for (int k = 0; k < Terms; ++k) {
+			if (k != j) {
+				product *= newX - xs[k];
+			}
+		}
+		if (product == 0) {
+			return false;
+		}
+
+		if (newX != oldX) {
+			for (int k = 0; k < Terms; ++k) {
+				if (k != j) {
+					weights[k] *= (xs[k] - oldX) / (xs[k] - newX);
+				}
+			}
+			weights[j] = 1 / product;
+			xs[j] = newX;
+		}
+		ys[j] = point.second;
+		return true;
+	}
+
+	double operator()(double x) const
+	{
+		double numerator = 0;
+		double denominator = 0;
+		for (int j = 0; j < Terms; ++j) {
+			const double difference = x - xs[j];
+			if (difference == 0) {
+				return ys[j];
+			}
+			const double term = weights[j] / difference;
+			numerator += term * ys[j];
+			denominator += term;
+		}
+		return numerator / denominator;
+	}
+
+	// ys[i] = p(xs[i]) for i < min(xs.size(), ys.size()).
+	void evaluate(std::span<const double> at, std::span<double> values) const
+	{
+		const size_t n = std::min(at.size(), values.size());
+		for (size_t i = 0; i < n; ++i) {
+			values[i] = (*this)(at[i]);
+		}
+	}
+
+	// Monomial coefficients, highest power first, by Newton's divided
+	// differences on the current points.
+	Coeffs coefficients() const
+	{
+		Coeffs p = Coeffs::Zero();
+		PolyFit<Degree>::interpolate([&](int i) { return std::pair<double, double>(xs[i], ys[i]); }, p);
+		return p;
+	}
+
+	std::pair<double, double> point(int j) const { return {xs[j], ys[j]}; }
+
+private:
+	double xs[Terms] = {};
+	double ys[Terms] = {};
+	double weights[Terms] = {};
+};
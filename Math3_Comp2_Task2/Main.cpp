@@ -16,6 +16,14 @@
 #include "Shader.h"
 #include "Camera.h"
 #include "CoordinateIteration.h"
+#include "PolyFit.h"
+#include "IncrementalPolyFit.h"
+#include "DOptimalDesign.h"
+#include "CurveSampler.h"
+#include "CurveUpload.h"
+#include "SampleViews.h"
+#include "PolyRoots.h"
+#include "CubicSpline.h"
 
 struct CallbackData {
     Shader* myShader;
@@ -39,13 +47,23 @@ std::vector<std::pair<double, double>> coordinates = {
 	};
 
 
+// Least-squares fit over everything in coordinates, kept current by addNewPoint and removePointByIndex.
+IncrementalPolyFit<3> liveFit;
+
+// Vertex buffer of the displayed cubic, refilled from liveFit after every edit.
+unsigned int curveVBO = 0;
+GLsizei curveVertexCount = 0;
+
 void addNewPoint(double x, double y);
 
-void removePointByIndex(std::vector<std::pair<double, double>> coordinates, size_t index);
+void removePointByIndex(size_t index);
+
+// Prints the cubic liveFit currently holds and uploads its samples into curveVBO.
+void showLiveFit();
 
 Eigen::MatrixXd addCoordinatesToMatrix(std::vector<std::pair<double, double>>& coordinates);
 
-Eigen::Vector4d findCubicPolynom(const std::vector<std::pair<double, double>>&);
+CubicSpline findCubicSpline(const std::vector<std::pair<double, double>>& coordinates, SplineBoundary boundary = SplineBoundary::Natural);
 
 std::vector<std::pair<double, double>> calculateCubicPolyPoints(double a, double b, double c, double d, double xStart, double xEnd, double xIncrement);
 
@@ -85,22 +103,27 @@ int main() {
 
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    std::vector<float> vertices;
-	
-
     Shader myShader("shader.vs", "shader.fs");
 
 	Eigen::MatrixXd matrix = addCoordinatesToMatrix(coordinates);
 	std::cout << "Start matrix:\n" << matrix << std::endl;
 
-	Eigen::Vector4d coeffs = findCubicPolynom(coordinates);
+	liveFit.rebuild(coordinates);
+
+	std::cout << "\nThe best conditioned points for an exact cubic (largest Vandermonde determinant) are:\n";
+	for (const auto& point : DOptimalDesign<3>::select(coordinates)) {
+		std::cout << "(" << point.first << ", " << point.second << ")\n";
+	}
+
+	const Eigen::Vector4d coeffs = liveFit.coeffs();
 	std::cout << "\nThe cubic coefficients are:\n";
     std::cout << "a: " << coeffs[0] << ", b: " << coeffs[1] << ", c: " << coeffs[2] << ", d: " << coeffs[3] << std::endl;
 
 	std::string equation = formatCubicEquation(coeffs[0], coeffs[1], coeffs[2], coeffs[3]);
 	std::cout << "\nThe cubic equation for this matrix is:\n"<< equation << std::endl;
 
-	std::vector<std::pair<double, double>> cubicPolyPoints = calculateCubicPolyPoints(coeffs[0], coeffs[1], coeffs[2], coeffs[3], -10, 10, 1);
+	// Evaluated lazily as the output loop below reads them; nothing is stored.
+	const SampleView cubicPolyPoints = samples(std::span<const double>(coeffs.data(), coeffs.size()), -10, 10, 1);
 
 	std::ofstream outFile("cubic_points.txt");
 	if (!outFile) {
@@ -110,22 +133,43 @@ int main() {
 	
 	outFile << "\nThe cubic equation for this matrix is:\n" << equation << "\n";
 
-	std::cout << "Calculated points on the cubic:\n";
-    for (const auto& point : cubicPolyPoints) {
-        std::cout << "(" << point.first << ", " << point.second << ")\n";
-		float x = static_cast<float>(point.first);
-		float y = static_cast<float>(point.second);
-
-		vertices.push_back(x);
-		vertices.push_back(y);
-		vertices.push_back(0.0f); //z
-    }
+	std::cout << "\nx-intercepts:";
+	outFile << "\nx-intercepts:";
+	for (double root : realRoots<3>(coeffs)) {
+		std::cout << " " << root;
+		outFile << " " << root;
+	}
+	std::cout << "\nExtrema:";
+	outFile << "\nExtrema:";
+	for (const Extremum& extremum : extrema<3>(coeffs)) {
+		const char* kind = extremum.minimum ? " minimum" : " maximum";
+		std::cout << kind << " (" << extremum.x << ", " << extremum.y << ")";
+		outFile << kind << " (" << extremum.x << ", " << extremum.y << ")";
+	}
+	std::cout << "\n";
+	outFile << "\n";
 
+	std::cout << "Calculated points on the cubic:\n";
 	outFile << "Calculated points on the cubic:\n";
     for (const auto& point : cubicPolyPoints) {
+        std::cout << "(" << point.first << ", " << point.second << ")\n";
         outFile << "(" << point.first << ", " << point.second << ")\n";
     }
 
+	const CubicSpline spline = findCubicSpline(coordinates);
+	std::cout << "Natural cubic spline through the points:\n";
+	outFile << "Natural cubic spline through the points:\n";
+	if (spline.size() > 0) {
+		const double start = spline.knots().front();
+		const double step = 0.5;
+		const size_t count = sampleCount(start, spline.knots().back(), step);
+		for (size_t i = 0; i < count; ++i) {
+			const double x = sampleX(start, step, i);
+			std::cout << "(" << x << ", " << spline(x) << ")\n";
+			outFile << "(" << x << ", " << spline(x) << ")\n";
+		}
+	}
+
 	outFile.close();
 
 	glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)800 / (float)600, 0.1f, 100.0f);
@@ -135,14 +179,14 @@ int main() {
     callbackData.myShader = &myShader;
     callbackData.myCamera = &camera;
 
-	unsigned int VBO, VAO;
+	unsigned int VAO;
 	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &curveVBO);
 
 	glBindVertexArray(VAO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	// Same samples as cubicPolyPoints, written by the sampler directly into the mapped VBO.
+	curveVertexCount = static_cast<GLsizei>(uploadCurve(curveVBO, std::span<const double>(coeffs.data(), coeffs.size()), -10, 10, 1, 3));
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
@@ -183,17 +227,17 @@ int main() {
 
 		glBindVertexArray(VAO);
 		
-		glDrawArrays(GL_LINE_STRIP, 0, vertices.size() / 3);
+		glDrawArrays(GL_LINE_STRIP, 0, curveVertexCount);
 
 		glPointSize(5.0f);
-		glDrawArrays(GL_POINTS, 0, vertices.size() / 3);
+		glDrawArrays(GL_POINTS, 0, curveVertexCount);
 
         glfwSwapBuffers(window);
         glfwPollEvents();	
 	}
 
     glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &curveVBO);
 	glfwTerminate();
 	return 0;
 
@@ -269,12 +313,30 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 void addNewPoint(double x, double y)
 {
 	coordinates.push_back({x, y});
+	liveFit.addPoint(x, y);
+	showLiveFit();
 }
 
-void removePointByIndex(std::vector<std::pair<double, double>> coordinates, size_t index)
+void removePointByIndex(size_t index)
 {
 	if(index < coordinates.size()){
+		liveFit.removePoint(coordinates[index].first, coordinates[index].second);
 		coordinates.erase(coordinates.begin() + index);
+		showLiveFit();
+	}
+}
+
+void showLiveFit()
+{
+	// Below four points the cubic is not determined; the last one stays on screen.
+	if (liveFit.size() < 4) {
+		return;
+	}
+	const Eigen::Vector4d coeffs = liveFit.coeffs();
+	std::cout << "\nThe cubic equation for the current points is:\n" << formatCubicEquation(coeffs[0], coeffs[1], coeffs[2], coeffs[3]) << std::endl;
+	if (curveVBO != 0) {
+		curveVertexCount = static_cast<GLsizei>(uploadCurve(curveVBO, std::span<const double>(coeffs.data(), coeffs.size()), -10, 10, 1, 3));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 }
 
@@ -283,46 +345,21 @@ Eigen::MatrixXd addCoordinatesToMatrix(std::vector<std::pair<double, double>>& c
 	Eigen::MatrixXd matrix(coordinates.size(), 4);
 
 	for(size_t i = 0; i < coordinates.size(); ++i){
-		double x = coordinates[i].first;
-		matrix(i, 0) = std::pow(x, 3);
-		matrix(i, 1) = std::pow(x, 2);
-		matrix(i, 2) = x;
-		matrix(i, 3) = 1;
+		PolyFit<3>::fillRow(matrix, i, coordinates[i].first);
 	}
 
 	return matrix;
 }
 
-Eigen::Vector4d findCubicPolynom(const std::vector<std::pair<double, double>>& coordinates)
+CubicSpline findCubicSpline(const std::vector<std::pair<double, double>>& coordinates, SplineBoundary boundary)
 {
-	int n = coordinates.size();
-	Eigen::MatrixXd A(n, 4);
-	Eigen::VectorXd b(n);
-
-	for (size_t i = 0; i < n; ++i) {
-		double x = coordinates[i].first;
-		double y = coordinates[i].second;
-		A(i, 0) = std::pow(x, 3);
-		A(i, 1) = std::pow(x, 2);
-		A(i, 2) = x;
-		A(i, 3) = 1;
-		b(i) = y;
-	}
-
-	Eigen::Vector4d coeffs = A.colPivHouseholderQr().solve(b);
-
-	return coeffs;
+	return CubicSpline::interpolate(coordinates, boundary);
 }
 
 std::vector<std::pair<double, double>> calculateCubicPolyPoints(double a, double b, double c, double d, double xStart, double xEnd, double xIncrement)
 {
-	std::vector<std::pair<double, double>> points;
-
-	for(double x = xStart; x <= xEnd; x += xIncrement){
-		double y = a * std::pow(x, 3) + b * std::pow(x, 2) + c * x + d;
-		points.emplace_back(x, y);
-	}
-	return points;
+	const double coeffs[] = {a, b, c, d};
+	return samplePolynomial(coeffs, xStart, xEnd, xIncrement);
 }
 
 std::string formatCubicEquation(double a, double b, double c, double d)
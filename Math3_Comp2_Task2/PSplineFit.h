@@ -0,0 +1,316 @@
+#pragma once
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Penalised B-spline least squares (P-spline, Eilers and Marx): a cubic
+// B-spline on `segments` equal intervals of [lo, hi], k = segments + 3
+// coefficients a, fitted by minimising
+//   |B a - y|^2 + lambda |D a|^2
+// where B is the n x k design matrix (row i holds the four cubic B-splines
+// that are non-zero at x_i) and D takes differences of order penaltyOrder of
+// neighbouring coefficients. lambda = 0 is the plain least-squares spline;
+// large lambda pulls the fit towards a polynomial of degree penaltyOrder - 1.
+//
+// Every row of B has four non-zeros, so nothing here is dense in n x k:
+//  - NormalEquations accumulates B^T B + lambda D^T D, a k x k band, and B^T y
+//    in one parallel pass over the points and factors the band with
+//    SimplicialLDLT. Memory is O(k) however many points there are, which is
+//    what tens of millions of points need.
+//  - QR reduces [B; sqrt(lambda) D] to its banded triangular factor R with
+//    Householder QR, one window of R at a time, and solves R a = Q^T y. It
+//    avoids squaring the condition number of B and also keeps memory at O(k),
+//    plus an index per point to take the rows in column order.
+enum class PSplineSolver {
+	NormalEquations,
+	QR
+};
+
+class PSpline {
+public:
+	static constexpr int Order = 4;
+
+	// Points per task of the accumulation pass.
+	static constexpr size_t Grain = 1 << 16;
+
+	// Most slices the accumulation pass of NormalEquations cuts the points
+	// into, each holding its own copy of the band.
+	static constexpr size_t MaxSlices = 64;
+
+	PSpline() = default;
+
+	static PSpline fit(std::span<const double> xs, std::span<const double> ys, size_t segments, double lambda, PSplineSolver solver = PSplineSolver::NormalEquations, int penaltyOrder = 2, ThreadPool& pool = ThreadPool::shared())
+	{
+		const size_t n = std::min(xs.size(), ys.size());
+		PSpline spline;
+		if (n == 0) {
+			return spline;
+		}
+
+		const auto [low, high] = std::minmax_element(xs.begin(), xs.begin() + n);
+		spline.lo = *low;
+		spline.hi = *high > *low ? *high : *low + 1;
+		spline.segments = std::max<size_t>(segments, 1);
+		spline.inverseWidth = static_cast<double>(spline.segments) / (spline.hi - spline.lo);
+
+		const Eigen::Index k = static_cast<Eigen::Index>(spline.segments) + Order - 1;
+		penaltyOrder = std::clamp<int>(penaltyOrder, 0, static_cast<int>(k) - 1);
+		lambda = std::max(lambda, 0.0);
+
+		spline.coeffs = solver == PSplineSolver::QR
+			? spline.solveQR(xs.first(n), ys.first(n), k, lambda, penaltyOrder)
+			: spline.solveNormal(xs.first(n), ys.first(n), k, lambda, penaltyOrder, pool);
+		return spline;
+	}
+
+	static PSpline fit(const PointSet& points, size_t segments, double lambda, PSplineSolver solver = PSplineSolver::NormalEquations, int penaltyOrder = 2, ThreadPool& pool = ThreadPool::shared())
+	{
+		std::vector<double> xs(points.size()), ys(points.size());
+		for (size_t i = 0; i < points.size(); ++i) {
+			xs[i] = points[i].first;
+			ys[i] = points[i].second;
+		}
+		return fit(xs, ys, segments, lambda, solver, penaltyOrder, pool);
+	}
+
+	const Eigen::VectorXd& coefficients() const { return coeffs; }
+	double lower() const { return lo; }
+	double upper() const { return hi; }
+
+	// Outside [lo, hi] the end segments' cubics are extended.
+	double operator()(double x) const
+	{
+		if (coeffs.size() == 0) {
+			return 0;
+		}
+		double b[Order];
+		const size_t first = basis(x, b);
+		double y = 0;
+		for (int j = 0; j < Order; ++j) {
+			y += b[j] * coeffs(static_cast<Eigen::Index>(first) + j);
+		}
+		return y;
+	}
+
+	// values[i] = S(at[i]) for i < min(at.size(), values.size()).
+	void evaluate(std::span<const double> at, std::span<double> values, ThreadPool& pool = ThreadPool::shared()) const
+	{
+		pool.parallelFor(std::min(at.size(), values.size()), Grain, [&](unsigned, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				values[i] = (*this)(at[i]);
+			}
+		});
+	}
+
+private:
+	// Writes the four cubic B-splines that are non-zero at x into b and
+	// returns the index of the first.
+	size_t basis(double x, double* b) const
+	{
+		const double u = (x - lo) * inverseWidth;
+		const size_t segment = u <= 0 ? 0 : std::min(static_cast<size_t>(u), segments - 1);
+		const double t = u - static_cast<double>(segment);
+		const double s = 1 - t;
+		b[0] = s * s * s / 6;
+		b[1] = ((3 * t - 6) * t * t + 4) / 6;
+		b[2] = (((-3 * t + 3) * t + 3) * t + 1) / 6;
+		b[3] = t * t * t / 6;
+		return segment;
+	}
+
+	// Coefficients of the order-d difference operator, (-1)^(d-i) C(d, i).
+	static std::vector<double> differenceStencil(int order)
+	{
+		std::vector<double> stencil(static_cast<size_t>(order) + 1, 0.0);
+		stencil[0] = 1;
+		for (int d = 1; d <= order; ++d) {
+			for (int i = d; i >= 0; --i) {
+				stencil[i] = (i > 0 ? stencil[i - 1] : 0.0) - stencil[i];
+			}
+		}
+		return stencil;
+	}
+
+	Eigen::VectorXd solveNormal(std::span<const double> xs, std::span<const double> ys, Eigen::Index k, double lambda, int penaltyOrder, ThreadPool& pool) const
+	{
+		// Band of B^T B stored by column: band[c * Order + o] = (B^T B)(c + o, c).
+		// The points are cut into a number of slices that depends only on n, each
+		// summed on its own and the slices added in order, so the result is the
+		// same whatever the thread count and whichever worker takes a slice.
+		const size_t n = xs.size();
+		const size_t slices = std::clamp<size_t>((n + Grain - 1) / Grain, 1, MaxSlices);
+		const size_t bandSize = static_cast<size_t>(k) * Order;
+		std::vector<std::vector<double>> bands(slices, std::vector<double>(bandSize, 0.0));
+		std::vector<Eigen::VectorXd> rhss(slices, Eigen::VectorXd::Zero(k));
+
+		pool.parallelFor(slices, 1, [&](unsigned, size_t sliceBegin, size_t sliceEnd) {
+			for (size_t slice = sliceBegin; slice < sliceEnd; ++slice) {
+				double* band = bands[slice].data();
+				Eigen::VectorXd& rhs = rhss[slice];
+				double b[Order];
+				for (size_t i = slice * n / slices; i < (slice + 1) * n / slices; ++i) {
+					const size_t first = basis(xs[i], b);
+					for (int c = 0; c < Order; ++c) {
+						double* column = band + (first + c) * Order;
+						for (int r = c; r < Order; ++r) {
+							column[r - c] += b[r] * b[c];
+						}
+						rhs(static_cast<Eigen::Index>(first) + c) += b[c] * ys[i];
+					}
+				}
+			}
+		});
+
+		for (size_t slice = 1; slice < slices; ++slice) {
+			for (size_t j = 0; j < bandSize; ++j) {
+				bands[0][j] += bands[slice][j];
+			}
+			rhss[0] += rhss[slice];
+		}
+
+		// Lower triangle of B^T B + lambda D^T D.
+		const std::vector<double> stencil = differenceStencil(penaltyOrder);
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(bandSize + static_cast<size_t>(k) * (1 + (penaltyOrder + 1) * (penaltyOrder + 2) / 2));
+		for (Eigen::Index c = 0; c < k; ++c) {
+			for (Eigen::Index o = 0; o < Order && c + o < k; ++o) {
+				entries.emplace_back(c + o, c, bands[0][static_cast<size_t>(c) * Order + o]);
+			}
+		}
+		if (lambda > 0) {
+			for (Eigen::Index row = 0; row + penaltyOrder < k; ++row) {
+				for (int c = 0; c <= penaltyOrder; ++c) {
+					for (int r = c; r <= penaltyOrder; ++r) {
+						entries.emplace_back(row + r, row + c, lambda * stencil[r] * stencil[c]);
+					}
+				}
+			}
+		}
+
+		// A B-spline whose support holds no points has a zero column in B, and
+		// with lambda = 0 nothing else reaches it, so LDLT would meet a zero
+		// pivot. Such coefficients are pinned to 0 by a unit-scale diagonal
+		// entry, the same answer solveQR gives for them.
+		if (lambda == 0) {
+			double largest = 0;
+			for (Eigen::Index c = 0; c < k; ++c) {
+				largest = std::max(largest, bands[0][static_cast<size_t>(c) * Order]);
+			}
+			const double tolerance = largest * static_cast<double>(k) * std::numeric_limits<double>::epsilon();
+			for (Eigen::Index c = 0; c < k; ++c) {
+				if (bands[0][static_cast<size_t>(c) * Order] <= tolerance) {
+					entries.emplace_back(c, c, largest);
+				}
+			}
+		}
+
+		Eigen::SparseMatrix<double> normal(k, k);
+		normal.setFromTriplets(entries.begin(), entries.end());
+		const Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::NaturalOrdering<int>> ldlt(normal);
+		if (ldlt.info() != Eigen::Success) {
+			return Eigen::VectorXd::Zero(k);
+		}
+		return ldlt.solve(rhss[0]);
+	}
+
+	// Rows are taken in order of their first non-zero column c: penalty row c,
+	// then the points of segment c. Each new row only reaches columns
+	// c, ..., c + width - 1, so it is folded into the width x width window of R
+	// at c by a small Householder QR, BlockRows rows at a time as in PolyFit,
+	// after which row c of R is final and the window moves on. In any other
+	// order every row would stay non-zero to the last column.
+	Eigen::VectorXd solveQR(std::span<const double> xs, std::span<const double> ys, Eigen::Index k, double lambda, int penaltyOrder) const
+	{
+		constexpr Eigen::Index BlockRows = PolyFit<1>::BlockRows;
+		const std::vector<double> stencil = differenceStencil(penaltyOrder);
+		const Eigen::Index penaltyRows = lambda > 0 ? k - penaltyOrder : 0;
+		const Eigen::Index width = std::max<Eigen::Index>(Order, penaltyOrder + 1);
+		const double weight = std::sqrt(lambda);
+
+		// Point indices by segment, a counting sort.
+		std::vector<size_t> groupStart(static_cast<size_t>(k) + 1, 0);
+		std::vector<size_t> order(xs.size());
+		double b[Order];
+		for (size_t i = 0; i < xs.size(); ++i) {
+			++groupStart[basis(xs[i], b) + 1];
+		}
+		for (size_t c = 1; c < groupStart.size(); ++c) {
+			groupStart[c] += groupStart[c - 1];
+		}
+		std::vector<size_t> next(groupStart.begin(), groupStart.end() - 1);
+		for (size_t i = 0; i < xs.size(); ++i) {
+			order[next[basis(xs[i], b)]++] = i;
+		}
+
+		// band(r, j) = R(r, r + j), with the transformed right-hand side in
+		// column width.
+		Eigen::MatrixXd band = Eigen::MatrixXd::Zero(k, width + 1);
+		Eigen::MatrixXd window = Eigen::MatrixXd::Zero(width, width + 1);
+		Eigen::MatrixXd block(width + BlockRows, width + 1);
+		for (Eigen::Index c = 0; c < k; ++c) {
+			const bool penalty = c < penaltyRows;
+			const size_t begin = groupStart[static_cast<size_t>(c)];
+			const size_t end = groupStart[static_cast<size_t>(c) + 1];
+			for (size_t start = begin; start < end || (penalty && start == begin); start += BlockRows - 1) {
+				const bool withPenalty = penalty && start == begin;
+				const size_t count = std::min<size_t>(BlockRows - 1, end - start);
+				const Eigen::Index rows = width + static_cast<Eigen::Index>(count) + (withPenalty ? 1 : 0);
+				block.resize(rows, width + 1);
+				block.setZero();
+				block.topRows(width) = window;
+				Eigen::Index row = width;
+				if (withPenalty) {
+					for (int j = 0; j <= penaltyOrder; ++j) {
+						block(row, j) = weight * stencil[j];
+					}
+					++row;
+				}
+				for (size_t p = start; p < start + count; ++p, ++row) {
+					basis(xs[order[p]], b);
+					for (int j = 0; j < Order; ++j) {
+						block(row, j) = b[j];
+					}
+					block(row, width) = ys[order[p]];
+				}
+
+				const Eigen::HouseholderQR<Eigen::MatrixXd> qr(block);
+				window = qr.matrixQR().topRows(width).triangularView<Eigen::Upper>();
+				if (end == begin) {
+					break;
+				}
+			}
+
+			// Row c is final; shift the window to start at column c + 1.
+			band.row(c) = window.row(0);
+			Eigen::MatrixXd shifted = Eigen::MatrixXd::Zero(width, width + 1);
+			shifted.topLeftCorner(width - 1, width - 1) = window.bottomRightCorner(width - 1, width).leftCols(width - 1);
+			shifted.col(width).head(width - 1) = window.col(width).tail(width - 1);
+			window = shifted;
+		}
+
+		// Back substitution. Columns with a negligible pivot (no data and no
+		// penalty reaching them) are set to zero.
+		const double tolerance = band.col(0).cwiseAbs().maxCoeff() * static_cast<double>(k) * std::numeric_limits<double>::epsilon();
+		Eigen::VectorXd a = Eigen::VectorXd::Zero(k);
+		for (Eigen::Index r = k - 1; r >= 0; --r) {
+			double sum = band(r, width);
+			for (Eigen::Index j = 1; j < width && r + j < k; ++j) {
+				sum -= band(r, j) * a(r + j);
+			}
+			a(r) = std::abs(band(r, 0)) > tolerance ? sum / band(r, 0) : 0.0;
+		}
+		return a;
+	}
+
+	Eigen::VectorXd coeffs;
+	double lo = 0;
+	double hi = 1;
+	double inverseWidth = 1;
+	size_t segments = 1;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <vector>
+#include "PolyFit.h"
+#include "ThreadPool.h"
+
+// Least-squares fits of many y-series sampled at the same x positions.
+// The Vandermonde matrix of the grid is factored once (column-pivoted QR)
+// and turned into its (Degree+1) x n pseudo-inverse P.
+// Fitting k series is then the single matrix product P * Y, with one series
+// per column of Y, instead of k separate factorizations.
+template<int Degree>
+class SharedGridFit {
+public:
+	static constexpr int Terms = Degree + 1;
+
+	using Coeffs = typename PolyFit<Degree>::Coeffs;
+	using CoeffMatrix = Eigen::Matrix<double, Terms, Eigen::Dynamic>;
+	using Pseudoinverse = Eigen::Matrix<double, Terms, Eigen::Dynamic>;
+
+	explicit SharedGridFit(const std::vector<double>& xs)
+	{
+		const Eigen::Index n = static_cast<Eigen::Index>(xs.size());
+
+		// Factor in u = (x - center) / halfWidth so the columns have comparable
+		// norms; the coefficient change back to x is folded into P below.
+		const auto [lo, hi] = std::minmax_element(xs.begin(), xs.end());
+		const double center = n ? 0.5 * (*lo + *hi) : 0.0;
+		const double halfWidth = n && *hi > *lo ? 0.5 * (*hi - *lo) : 1.0;
+
+		Eigen::Matrix<double, Eigen::Dynamic, Terms> A(n, Terms);
+		for (Eigen::Index i = 0; i < n; ++i) {
+			PolyFit<Degree>::fillRow(A, i, (xs[i] - center) / halfWidth);
+		}
+
+		const Eigen::ColPivHouseholderQR<Eigen::Matrix<double, Eigen::Dynamic, Terms>> qr(A);
+		const Eigen::Index rank = qr.rank();
+
+		// P = Pi * R^-1 * Q1^T, with the columns past the rank left at zero.
+		Eigen::Matrix<double, Eigen::Dynamic, Terms> thinQ = Eigen::Matrix<double, Eigen::Dynamic, Terms>::Identity(n, Terms);
+		thinQ.applyOnTheLeft(qr.householderQ());
+
+		Pseudoinverse unpermuted = Pseudoinverse::Zero(Terms, n);
+		unpermuted.topRows(rank) = thinQ.leftCols(rank).transpose();
+		qr.matrixQR().topLeftCorner(rank, rank).template triangularView<Eigen::Upper>().solveInPlace(unpermuted.topRows(rank));
+
+		Pseudoinverse scaledP(Terms, n);
+		for (Eigen::Index i = 0; i < Terms; ++i) {
+			scaledP.row(qr.colsPermutation().indices()(i)) = unpermuted.row(i);
+		}
+
+		// Row k of scaledP gives the coefficient of u^(Degree-k). Map it back
+		// to x: divide by halfWidth^(Degree-k), then shift by center.
+		Eigen::Matrix<double, Terms, Terms> toX;
+		for (int k = 0; k < Terms; ++k) {
+			Coeffs unit = Coeffs::Zero();
+			unit(k) = 1.0;
+			for (int j = 0; j < Degree - k; ++j) {
+				unit(k) /= halfWidth;
+			}
+			toX.col(k) = PolyFit<Degree>::translate(unit, center);
+		}
+
+		P.noalias() = toX * scaledP;
+	}
+
+	Eigen::Index gridSize() const { return P.cols(); }
+
+	const Pseudoinverse& pseudoinverse() const { return P; }
+
+	Coeffs solve(const Eigen::VectorXd& y) const
+	{
+		return P * y;
+	}
+
+	// Y is n x k with one series per column; the result is (Degree+1) x k.
+	// Column blocks are multiplied on separate threads.
+	CoeffMatrix solve(const Eigen::MatrixXd& Y, ThreadPool& pool = ThreadPool::shared()) const
+	{
+		CoeffMatrix coeffs(Terms, Y.cols());
+		pool.parallelFor(static_cast<size_t>(Y.cols()), 2048, [&](unsigned, size_t begin, size_t end) {
+			const Eigen::Index count = static_cast<Eigen::Index>(end - begin);
+			coeffs.middleCols(begin, count).noalias() = P * Y.middleCols(begin, count);
+		});
+		return coeffs;
+	}
+
+private:
+	Pseudoinverse P;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "PolyFit.h"
+
+// Least-squares polynomial fit over the last `window` samples of a stream.
+// A new sample costs one rank-1 update of the Cholesky factor of the normal
+// matrix and, once the window is full, one rank-1 downdate for the sample that
+// falls out, O(Degree^2) each. Downdates lose accuracy over time, so the
+// factor is rebuilt from the buffered samples every `refactorInterval`
+// samples and whenever a downdate fails or leaves a suspiciously small pivot.
+// The rebuild also maps the current window onto u in [-1, 1], which keeps the
+// powers of a growing x small and the pivots of the factor comparable.
+template<int Degree, typename Scalar = double>
+class WindowedPolyFit {
+public:
+	static constexpr int Terms = Degree + 1;
+
+	using Coeffs = typename PolyFit<Degree, Scalar>::Coeffs;
+
+	explicit WindowedPolyFit(size_t window, size_t refactorInterval = 0)
+		: samples(std::max<size_t>(window, 1)),
+		  interval(refactorInterval ? refactorInterval : std::max<size_t>(window, 1))
+	{
+	}
+
+	void push(double x, double y)
+	{
+		const bool evicting = count == samples.size();
+		const std::pair<double, double> evicted = samples[head];
+
+		samples[head] = {x, y};
+		head = (head + 1) % samples.size();
+		count = std::min(count + 1, samples.size());
+		dirty = true;
+
+		if (!factorValid || ++sinceRefactor >= interval) {
+			refactor();
+			return;
+		}
+
+		const Coeffs added = basis(x);
+		factor.rankUpdate(added, Scalar(1));
+		rhs += static_cast<Scalar>(y) * added;
+
+		if (evicting) {
+			const Coeffs removed = basis(evicted.first);
+			factor.rankUpdate(removed, Scalar(-1));
+			rhs -= static_cast<Scalar>(evicted.second) * removed;
+		}
+
+		if (!factorHealthy()) {
+			refactor();
+		}
+	}
+
+	size_t size() const { return count; }
+	size_t window() const { return samples.size(); }
+	size_t refactorCount() const { return refactors; }
+
+	// Highest power first, in the original x coordinates.
+	const Coeffs& coeffs() const
+	{
+		if (dirty) {
+			if (factorValid) {
+				Coeffs scaled = factor.solve(rhs);
+				Scalar unit = Scalar(1);
+				for (int k = Degree; k >= 0; --k) {
+					scaled(k) *= unit;
+					unit *= inverseScale;
+				}
+				cached = PolyFit<Degree, Scalar>::translate(scaled, origin);
+			} else {
+				cached = PolyFit<Degree, Scalar>::fit(static_cast<Eigen::Index>(count), [&](Eigen::Index i) {
+					return samples[(head + samples.size() - count + i) % samples.size()];
+				});
+			}
+			dirty = false;
+		}
+		return cached;
+	}
+
+private:
+	using Matrix = Eigen::Matrix<Scalar, Terms, Terms>;
+
+	Coeffs basis(double x) const
+	{
+		Coeffs phi;
+		Scalar power = Scalar(1);
+		const Scalar u = (static_cast<Scalar>(x) - origin) * inverseScale;
+		for (int k = Degree; k >= 0; --k) {
+			phi(k) = power;
+			power *= u;
+		}
+		return phi;
+	}
+
+	// A downdate can drive a pivot negative (LLT reports it) or leave it
+	// positive but dominated by cancellation. Both mean the factor no longer
+	// describes the window well enough to trust.
+	bool factorHealthy() const
+	{
+		if (factor.info() != Eigen::Success) {
+			return false;
+		}
+		const auto diagonal = factor.matrixLLT().diagonal().cwiseAbs();
+		const Scalar smallest = diagonal.minCoeff();
+		return std::isfinite(smallest) && smallest > diagonal.maxCoeff() * std::sqrt(std::numeric_limits<Scalar>::epsilon());
+	}
+
+	void refactor()
+	{
+		double lo = std::numeric_limits<double>::max();
+		double hi = std::numeric_limits<double>::lowest();
+		for (size_t i = 0; i < count; ++i) {
+			lo = std::min(lo, samples[i].first);
+			hi = std::max(hi, samples[i].first);
+		}
+		origin = static_cast<Scalar>(count ? 0.5 * (lo + hi) : 0.0);
+		inverseScale = static_cast<Scalar>(count && hi > lo ? 2.0 / (hi - lo) : 1.0);
+
+		Matrix normal = Matrix::Zero();
+		rhs.setZero();
+		for (size_t i = 0; i < count; ++i) {
+			const Coeffs phi = basis(samples[i].first);
+			normal.template selfadjointView<Eigen::Lower>().rankUpdate(phi);
+			rhs += static_cast<Scalar>(samples[i].second) * phi;
+		}
+
+		factor.compute(normal);
+		factorValid = count >= static_cast<size_t>(Terms) && factorHealthy();
+		sinceRefactor = 0;
+		++refactors;
+	}
+
+	std::vector<std::pair<double, double>> samples;
+	size_t head = 0;
+	size_t count = 0;
+	size_t interval;
+	size_t sinceRefactor = 0;
+	size_t refactors = 0;
+
+	Eigen::LLT<Matrix> factor;
+	Coeffs rhs = Coeffs::Zero();
+	Scalar origin = Scalar(0);
+	Scalar inverseScale = Scalar(1);
+	bool factorValid = false;
+
+	mutable Coeffs cached = Coeffs::Zero();
+	mutable bool dirty = true;
+};